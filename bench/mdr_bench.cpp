@@ -0,0 +1,322 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <limits>
+#include <chrono>
+#include <algorithm>
+#include <sys/resource.h>
+#include "utils.hpp"
+#include "Refactor/Refactor.hpp"
+#include "Reconstructor/Reconstructor.hpp"
+#include "Synthetic/SyntheticField.hpp"
+
+// Benchmark sweep over decomposer x interleaver x encoder x compressor x size interpreter
+// data is refactored into and retrieved from memory so that only the pipeline itself is measured
+// one JSON object per line: a "refactor" record per component combination and a "retrieve" record per tolerance
+//
+// usage: mdr_bench [-o output] [-d num_dims dim0 ...] [-f data_file num_dims dim0 ...] [-l target_level] [-b num_bitplanes]
+//                  [-t num_tolerances tol0 ...] [-r repeats] [-a malloc|arena]
+// tolerances are relative to the value range of each dataset; -f can be given several times
+// components report progress on stdout, -o keeps the records apart from it
+
+using namespace std;
+
+using T = float;
+using T_stream = uint32_t;
+
+struct Dataset{
+    string name;
+    vector<uint32_t> dims;
+    vector<T> data;
+};
+
+struct BenchConfig{
+    uint8_t target_level = 4;
+    uint8_t num_bitplanes = 32;
+    int repeats = 3;
+    vector<double> tolerances = {1e-1, 1e-2, 1e-3, 1e-4, 1e-5};
+    string allocator = "malloc";
+    ostream * out = &cout;
+};
+
+// names of the components of one combination
+struct Combination{
+    string decomposer;
+    string interleaver;
+    string encoder;
+    string compressor;
+    string allocator;
+};
+
+// the greedy interpreter and max error constant depend on the encoder
+template<class Encoder>
+struct EncoderTraits{
+    template<class ErrorEstimator> using GreedyInterpreter = MDR::SignExcludeGreedyBasedSizeInterpreter<ErrorEstimator>;
+    static double max_error_scale(){ return 1; }
+};
+template<class T_data, class T_bitplane>
+struct EncoderTraits<MDR::NegaBinaryBPEncoder<T_data, T_bitplane>>{
+    template<class ErrorEstimator> using GreedyInterpreter = MDR::NegaBinaryGreedyBasedSizeInterpreter<ErrorEstimator>;
+    // 2 more bitplanes for negabinary
+    static double max_error_scale(){ return 4; }
+};
+
+// peak resident set size since the last reset, in KiB
+static void reset_peak_rss(){
+    ofstream clear_refs("/proc/self/clear_refs");
+    if(clear_refs) clear_refs << "5";
+}
+static uint64_t peak_rss_kb(){
+    ifstream status("/proc/self/status");
+    string line;
+    while(getline(status, line)){
+        if(line.compare(0, 6, "VmHWM:") == 0) return strtoull(line.c_str() + 6, NULL, 10);
+    }
+    // process lifetime peak if VmHWM is not available
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+static double seconds_since(const chrono::steady_clock::time_point& start){
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static double value_range(const vector<T>& data){
+    auto minmax = minmax_element(data.begin(), data.end());
+    return *minmax.second - *minmax.first;
+}
+
+static string json_prefix(const char * type, const Dataset& dataset, const Combination& c){
+    ostringstream s;
+    s << "{\"type\":\"" << type << "\",\"dataset\":\"" << dataset.name << "\",\"dims\":[";
+    for(int i=0; i<dataset.dims.size(); i++) s << (i ? "," : "") << dataset.dims[i];
+    s << "],\"decomposer\":\"" << c.decomposer << "\",\"interleaver\":\"" << c.interleaver << "\",\"encoder\":\"" << c.encoder << "\",\"compressor\":\"" << c.compressor << "\",\"allocator\":\"" << c.allocator << "\"";
+    return s.str();
+}
+
+// progressive retrieval at decreasing tolerances
+// interpreters that use the rate-distortion index get it before the timed requests, as if stored by the refactor
+template<class Decomposer, class Interleaver, class Encoder, class Compressor, class SizeInterpreter, class ErrorEstimator>
+void bench_retrieval(shared_ptr<MDR::InMemoryStore> store, const Dataset& dataset, const BenchConfig& config, const Combination& c, const ErrorEstimator& estimator, const MDR::RateDistortionIndex& rd_index, const char * estimator_name, const char * interpreter_name){
+    const bool max_error = is_base_of<MDR::MaxErrorEstimator<T>, ErrorEstimator>::value;
+    SizeInterpreter interpreter(estimator);
+    interpreter.load_rate_distortion_index(rd_index);
+    auto reconstructor = MDR::ComposedReconstructor<T, Decomposer, Interleaver, Encoder, Compressor, SizeInterpreter, ErrorEstimator, MDR::InMemoryRetriever>(Decomposer(), Interleaver(), Encoder(), Compressor(), interpreter, MDR::InMemoryRetriever(store));
+    reconstructor.load_metadata();
+    const double range = value_range(dataset.data);
+    const size_t num_elements = dataset.data.size();
+    vector<double> tolerances(config.tolerances);
+    sort(tolerances.begin(), tolerances.end(), greater<double>());
+    for(const auto& tolerance:tolerances){
+        // squared error estimators bound the sum of squared errors
+        double requested = max_error ? tolerance * range : tolerance * range * tolerance * range * num_elements;
+        auto start = chrono::steady_clock::now();
+        T * reconstructed = reconstructor.progressive_reconstruct(requested);
+        double time = seconds_since(start);
+        uint64_t retrieved_size = 0;
+        const auto& level_sizes = reconstructor.get_level_sizes();
+        const auto& level_num_bitplanes = reconstructor.get_level_num_bitplanes();
+        for(int i=0; i<level_sizes.size(); i++){
+            for(int j=0; j<level_num_bitplanes[i]; j++){
+                retrieved_size += level_sizes[i][j];
+            }
+        }
+        double max_abs_error = 0;
+        double squared_error = 0;
+        for(size_t i=0; i<num_elements; i++){
+            double e = (double) reconstructed[i] - dataset.data[i];
+            max_abs_error = max(max_abs_error, fabs(e));
+            squared_error += e * e;
+        }
+        *config.out << json_prefix("retrieve", dataset, c) << ",\"estimator\":\"" << estimator_name << "\",\"interpreter\":\"" << interpreter_name
+            << "\",\"tolerance\":" << tolerance << ",\"retrieved_bytes\":" << retrieved_size << ",\"bitrate\":" << retrieved_size * 8.0 / num_elements
+            << ",\"max_abs_error\":" << max_abs_error << ",\"rmse\":" << sqrt(squared_error / num_elements)
+            << ",\"time\":" << time << ",\"throughput_MBps\":" << num_elements * sizeof(T) / time / 1e6 << "}" << endl;
+    }
+}
+
+template<class Decomposer, class Interleaver, class Encoder, class Compressor, class ErrorEstimator>
+void bench_interpreters(shared_ptr<MDR::InMemoryStore> store, const Dataset& dataset, const BenchConfig& config, const Combination& c, const ErrorEstimator& estimator, const char * estimator_name){
+    // the refactor is shared by all estimators, so the index of this estimator is built here from the stored metadata
+    MDR::RateDistortionIndex rd_index;
+    {
+        typedef MDR::RateDistortionSizeInterpreter<ErrorEstimator> Interpreter;
+        auto reconstructor = MDR::ComposedReconstructor<T, Decomposer, Interleaver, Encoder, Compressor, Interpreter, ErrorEstimator, MDR::InMemoryRetriever>(Decomposer(), Interleaver(), Encoder(), Compressor(), Interpreter(estimator), MDR::InMemoryRetriever(store));
+        reconstructor.load_metadata();
+        rd_index = MDR::build_rate_distortion_index(reconstructor.get_level_sizes(), reconstructor.get_level_errors(), estimator);
+    }
+    bench_retrieval<Decomposer, Interleaver, Encoder, Compressor, typename EncoderTraits<Encoder>::template GreedyInterpreter<ErrorEstimator>>(store, dataset, config, c, estimator, rd_index, estimator_name, "greedy");
+    bench_retrieval<Decomposer, Interleaver, Encoder, Compressor, MDR::RoundRobinSizeInterpreter<ErrorEstimator>>(store, dataset, config, c, estimator, rd_index, estimator_name, "round_robin");
+    bench_retrieval<Decomposer, Interleaver, Encoder, Compressor, MDR::InorderSizeInterpreter<ErrorEstimator>>(store, dataset, config, c, estimator, rd_index, estimator_name, "inorder");
+    bench_retrieval<Decomposer, Interleaver, Encoder, Compressor, MDR::RateDistortionSizeInterpreter<ErrorEstimator>>(store, dataset, config, c, estimator, rd_index, estimator_name, "rate_distortion");
+    bench_retrieval<Decomposer, Interleaver, Encoder, Compressor, MDR::OptimalSizeInterpreter<ErrorEstimator>>(store, dataset, config, c, estimator, rd_index, estimator_name, "optimal");
+}
+
+template<class Decomposer, class Interleaver, class Encoder, class Compressor>
+void bench_combination(const Dataset& dataset, const BenchConfig& config, const Combination& c){
+    auto store = make_shared<MDR::InMemoryStore>();
+    const uint64_t input_size = dataset.data.size() * sizeof(T);
+    double best_time = numeric_limits<double>::max();
+    uint64_t peak_rss = 0;
+    for(int r=0; r<config.repeats; r++){
+        auto refactor = MDR::ComposedRefactor<T, Decomposer, Interleaver, Encoder, Compressor, MDR::MaxErrorCollector<T>, MDR::InMemoryWriter>(Decomposer(), Interleaver(), Encoder(), Compressor(), MDR::MaxErrorCollector<T>(), MDR::InMemoryWriter(store));
+        vector<T> input(dataset.data);
+        reset_peak_rss();
+        auto start = chrono::steady_clock::now();
+        refactor.refactor(move(input), dataset.dims, config.target_level, config.num_bitplanes);
+        best_time = min(best_time, seconds_since(start));
+        peak_rss = max(peak_rss, peak_rss_kb());
+    }
+    uint64_t refactored_size = store->size();
+    *config.out << json_prefix("refactor", dataset, c) << ",\"input_bytes\":" << input_size << ",\"refactored_bytes\":" << refactored_size
+        << ",\"compression_ratio\":" << input_size * 1.0 / refactored_size << ",\"time\":" << best_time << ",\"throughput_MBps\":" << input_size / best_time / 1e6
+        << ",\"peak_rss_kb\":" << peak_rss << "}" << endl;
+
+    const int num_dims = dataset.dims.size();
+    vector<T> level_c(config.target_level + 1, MDR::MaxErrorEstimatorOB<T>(num_dims).estimate_error(1, 0) * EncoderTraits<Encoder>::max_error_scale());
+    bench_interpreters<Decomposer, Interleaver, Encoder, Compressor>(store, dataset, config, c, MDR::MaxErrorEstimatorOB<T>(level_c), "max");
+    bench_interpreters<Decomposer, Interleaver, Encoder, Compressor>(store, dataset, config, c, MDR::SNormErrorEstimator<T>(num_dims, config.target_level, 0), "l2");
+}
+
+template<class Decomposer, class Interleaver, class Encoder>
+void sweep_compressors(const Dataset& dataset, const BenchConfig& config, Combination c){
+    c.compressor = "default";
+    bench_combination<Decomposer, Interleaver, Encoder, MDR::DefaultLevelCompressor>(dataset, config, c);
+    c.compressor = "adaptive";
+    bench_combination<Decomposer, Interleaver, Encoder, MDR::AdaptiveLevelCompressor>(dataset, config, c);
+    c.compressor = "null";
+    bench_combination<Decomposer, Interleaver, Encoder, MDR::NullLevelCompressor>(dataset, config, c);
+    c.compressor = "chunked";
+    bench_combination<Decomposer, Interleaver, Encoder, MDR::ChunkedLevelCompressor>(dataset, config, c);
+}
+
+template<class Decomposer, class Interleaver>
+void sweep_encoders(const Dataset& dataset, const BenchConfig& config, Combination c){
+    c.encoder = "grouped";
+    sweep_compressors<Decomposer, Interleaver, MDR::GroupedBPEncoder<T, T_stream>>(dataset, config, c);
+    c.encoder = "negabinary";
+    sweep_compressors<Decomposer, Interleaver, MDR::NegaBinaryBPEncoder<T, T_stream>>(dataset, config, c);
+    c.encoder = "perbit";
+    sweep_compressors<Decomposer, Interleaver, MDR::PerBitBPEncoder<T, T_stream>>(dataset, config, c);
+}
+
+template<class Decomposer>
+void sweep_interleavers(const Dataset& dataset, const BenchConfig& config, Combination c){
+    c.interleaver = "direct";
+    sweep_encoders<Decomposer, MDR::DirectInterleaver<T>>(dataset, config, c);
+    c.interleaver = "sfc";
+    sweep_encoders<Decomposer, MDR::SFCInterleaver<T>>(dataset, config, c);
+    c.interleaver = "blocked";
+    sweep_encoders<Decomposer, MDR::BlockedInterleaver<T>>(dataset, config, c);
+}
+
+void sweep(const Dataset& dataset, const BenchConfig& config){
+    Combination c;
+    c.allocator = config.allocator;
+    c.decomposer = "orthogonal";
+    sweep_interleavers<MDR::MGARDOrthoganalDecomposer<T>>(dataset, config, c);
+    c.decomposer = "hierarchical";
+    sweep_interleavers<MDR::MGARDHierarchicalDecomposer<T>>(dataset, config, c);
+}
+
+template<class Field>
+Dataset synthetic_dataset(const string& name, const vector<uint32_t>& dims, const Field& field){
+    Dataset dataset;
+    dataset.name = name;
+    dataset.dims = dims;
+    dataset.data = field.template generate<T>(dims);
+    return dataset;
+}
+
+vector<Dataset> synthetic_datasets(const vector<uint32_t>& dims){
+    vector<Dataset> datasets;
+    datasets.push_back(synthetic_dataset("gaussian", dims, MDR::GaussianRandomField(3, 256, 64, 42)));
+    datasets.push_back(synthetic_dataset("turbulent", dims, MDR::TurbulenceField(32, 512, 42)));
+    datasets.push_back(synthetic_dataset("sparse", dims, MDR::SparseField(0.01, 42)));
+    datasets.push_back(synthetic_dataset("discontinuous", dims, MDR::DiscontinuousField(8, 1, 42)));
+    return datasets;
+}
+
+static vector<uint32_t> parse_dims(int argc, char ** argv, int& argv_id){
+    int num_dims = atoi(argv[argv_id ++]);
+    vector<uint32_t> dims(num_dims, 0);
+    for(int i=0; i<num_dims; i++){
+        dims[i] = atoi(argv[argv_id ++]);
+    }
+    return dims;
+}
+
+int main(int argc, char ** argv){
+    BenchConfig config;
+    vector<uint32_t> synthetic_dims = {65, 65, 65};
+    vector<Dataset> datasets;
+    string output_file;
+    int argv_id = 1;
+    while(argv_id < argc){
+        string option = string(argv[argv_id ++]);
+        if(option == "-o") output_file = string(argv[argv_id ++]);
+        else if(option == "-d") synthetic_dims = parse_dims(argc, argv, argv_id);
+        else if(option == "-f"){
+            Dataset dataset;
+            dataset.name = string(argv[argv_id ++]);
+            dataset.dims = parse_dims(argc, argv, argv_id);
+            size_t num_elements = 0;
+            dataset.data = MGARD::readfile<T>(dataset.name.c_str(), num_elements);
+            size_t expected_elements = 1;
+            for(const auto& d:dataset.dims) expected_elements *= d;
+            if(num_elements != expected_elements){
+                cerr << "File " << dataset.name << " holds " << num_elements << " elements, dimensions give " << expected_elements << endl;
+                return -1;
+            }
+            datasets.push_back(dataset);
+        }
+        else if(option == "-l") config.target_level = atoi(argv[argv_id ++]);
+        else if(option == "-b") config.num_bitplanes = atoi(argv[argv_id ++]);
+        else if(option == "-t"){
+            int num_tolerances = atoi(argv[argv_id ++]);
+            config.tolerances.clear();
+            for(int i=0; i<num_tolerances; i++){
+                config.tolerances.push_back(atof(argv[argv_id ++]));
+            }
+        }
+        else if(option == "-r") config.repeats = atoi(argv[argv_id ++]);
+        else if(option == "-a") config.allocator = string(argv[argv_id ++]);
+        else{
+            cerr << "Unknown option " << option << endl;
+            return -1;
+        }
+    }
+    if(config.num_bitplanes % 2 == 1){
+        config.num_bitplanes += 1;
+        cerr << "Change to " << +config.num_bitplanes << " bitplanes for simplicity of negabinary encoding" << endl;
+    }
+    if(config.allocator != "malloc" && config.allocator != "arena"){
+        cerr << "Unknown allocator " << config.allocator << endl;
+        return -1;
+    }
+    // buffers of all components are drawn from the arena for the whole sweep
+    MDR::ArenaAllocator arena;
+    MDR::AllocatorScope allocator_scope((config.allocator == "arena") ? &arena : NULL);
+    auto synthetic = synthetic_datasets(synthetic_dims);
+    datasets.insert(datasets.begin(), synthetic.begin(), synthetic.end());
+
+    ofstream output;
+    if(output_file.size()){
+        output.open(output_file);
+        if(!output){
+            cerr << "Errors in opening output " << output_file << endl;
+            return -1;
+        }
+        config.out = &output;
+    }
+    for(const auto& dataset:datasets){
+        cerr << "Benchmarking " << dataset.name << endl;
+        sweep(dataset, config);
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+#ifndef _MDR_ALLOCATOR_HPP
+#define _MDR_ALLOCATOR_HPP
+
+#include "AllocatorInterface.hpp"
+#include "MallocAllocator.hpp"
+#include "ArenaAllocator.hpp"
+#include "MemoryTracker.hpp"
+
+namespace MDR {
+    inline concepts::AllocatorInterface * default_allocator(){
+        static MallocAllocator allocator;
+        return &allocator;
+    }
+
+    // Allocator used by all MDR components on the calling thread, malloc by default
+    // ThreadPool tasks run with the allocator of the thread that submitted them
+    inline concepts::AllocatorInterface *& current_allocator(){
+        static thread_local concepts::AllocatorInterface * allocator = default_allocator();
+        return allocator;
+    }
+
+    // install an allocator on the calling thread, NULL restores the default
+    // the previous allocator must stay alive until the buffers it allocated are freed
+    inline void set_allocator(concepts::AllocatorInterface * allocator){
+        current_allocator() = allocator ? allocator : default_allocator();
+    }
+
+    // Install an allocator for the enclosing scope and restore the previous one on exit
+    // e.g. an ArenaAllocator around a refactor or a retrieval request; other threads keep their own allocator
+    class AllocatorScope {
+    public:
+        AllocatorScope(concepts::AllocatorInterface * allocator) : prev_allocator(current_allocator()) {
+            set_allocator(allocator);
+        }
+        AllocatorScope(const AllocatorScope&) = delete;
+        AllocatorScope& operator=(const AllocatorScope&) = delete;
+
+        ~AllocatorScope(){
+            set_allocator(prev_allocator);
+        }
+    private:
+        concepts::AllocatorInterface * prev_allocator;
+    };
+
+    // allocator that must free ptr: the arena that allocated it, even once another allocator is installed
+    inline concepts::AllocatorInterface * owning_allocator(void * ptr){
+        ArenaAllocator * arena = ArenaAllocator::owner(ptr);
+        return arena ? arena : current_allocator();
+    }
+
+    // malloc/realloc/free replacements for MDR buffers, accounted by the MemoryTracker when enabled
+    inline void * allocate(size_t size){
+        void * ptr = current_allocator()->allocate(size);
+        if(MemoryTracker::instance().enabled()) MemoryTracker::instance().on_allocate(ptr, size);
+        return ptr;
+    }
+
+    inline void * reallocate(void * ptr, size_t size){
+        void * new_ptr = owning_allocator(ptr)->reallocate(ptr, size);
+        if(new_ptr && MemoryTracker::instance().enabled()) MemoryTracker::instance().on_reallocate(ptr, new_ptr, size);
+        return new_ptr;
+    }
+
+    inline void deallocate(void * ptr){
+        if(MemoryTracker::instance().enabled()) MemoryTracker::instance().on_deallocate(ptr);
+        owning_allocator(ptr)->deallocate(ptr);
+    }
+
+    // end of a level in the pipeline, once all of its buffers are freed
+    inline void release_level(int level){
+        current_allocator()->release_level(level);
+    }
+}
+#endif
@@ -0,0 +1,28 @@
+#ifndef _MDR_ALLOCATOR_INTERFACE_HPP
+#define _MDR_ALLOCATOR_INTERFACE_HPP
+
+#include <cstddef>
+
+namespace MDR {
+    namespace concepts {
+
+        // Raw buffer allocator behind the buffers of all MDR components
+        class AllocatorInterface {
+        public:
+
+            virtual ~AllocatorInterface() = default;
+
+            virtual void * allocate(size_t size) = 0;
+
+            virtual void * reallocate(void * ptr, size_t size) = 0;
+
+            virtual void deallocate(void * ptr) = 0;
+
+            // all buffers of the level are freed; level-scoped allocators recycle its memory at once
+            virtual void release_level(int level) {}
+
+            virtual void print() const = 0;
+        };
+    }
+}
+#endif
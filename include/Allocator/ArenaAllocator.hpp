@@ -0,0 +1,261 @@
+#ifndef _MDR_ARENA_ALLOCATOR_HPP
+#define _MDR_ARENA_ALLOCATOR_HPP
+
+#include "AllocatorInterface.hpp"
+#include "MemoryTracker.hpp"
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <mutex>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+
+namespace MDR {
+    // Arena allocator: buffers are carved from large chunks by a pointer bump
+    // every level draws from its own chunks (the level of the allocating thread, see MemoryScope), so buffers
+    // kept by one level do not pin the memory of the others; release_level tears a level down at once and
+    // hands its chunks to the next level, and freeing the most recent buffer rolls the bump pointer back
+    // chunks are only returned to the system by release()
+    // live arenas are registered, so their buffers are returned to them whichever allocator is installed;
+    // buffers not allocated by an arena (e.g. allocated before it was installed) are passed to realloc/free
+    class ArenaAllocator : public concepts::AllocatorInterface {
+    public:
+        ArenaAllocator(size_t chunk_size = ((size_t) 64 << 20)) : chunk_size(chunk_size) {
+            std::lock_guard<std::mutex> lock(registry_mutex());
+            registry().push_back(this);
+            num_arenas() ++;
+        }
+        ArenaAllocator(const ArenaAllocator&) = delete;
+        ArenaAllocator& operator=(const ArenaAllocator&) = delete;
+
+        ~ArenaAllocator(){
+            {
+                std::lock_guard<std::mutex> lock(registry_mutex());
+                registry().erase(std::find(registry().begin(), registry().end(), this));
+                num_arenas() --;
+            }
+            release();
+        }
+
+        // live arena that allocated ptr, NULL if none
+        static ArenaAllocator * owner(const void * ptr){
+            if(ptr == NULL || num_arenas() == 0) return NULL;
+            std::lock_guard<std::mutex> lock(registry_mutex());
+            for(auto arena:registry()){
+                if(arena->owns(ptr)) return arena;
+            }
+            return NULL;
+        }
+
+        bool owns(const void * ptr) const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return find_chunk(ptr) >= 0;
+        }
+
+        void * allocate(size_t size){
+            std::lock_guard<std::mutex> lock(mutex);
+            return allocate_unlocked(size);
+        }
+
+        void * reallocate(void * ptr, size_t size){
+            if(ptr == NULL) return allocate(size);
+            std::lock_guard<std::mutex> lock(mutex);
+            int id = find_chunk(ptr);
+            if(id < 0) return realloc(ptr, size);
+            uint8_t * block = reinterpret_cast<uint8_t*>(ptr) - header_size;
+            const size_t old_size = header(block);
+            Chunk& c = chunks[id];
+            // grow or shrink the most recent buffer in place
+            if(is_current(id) && block == c.data + c.last && c.last + header_size + align(size) <= c.size){
+                c.offset = c.last + header_size + align(size);
+                header(block) = size;
+                return ptr;
+            }
+            void * new_ptr = allocate_unlocked(size);
+            if(new_ptr == NULL) return NULL;
+            memcpy(new_ptr, ptr, std::min(old_size, size));
+            deallocate_unlocked(id, block);
+            return new_ptr;
+        }
+
+        void deallocate(void * ptr){
+            if(ptr == NULL) return;
+            std::lock_guard<std::mutex> lock(mutex);
+            int id = find_chunk(ptr);
+            if(id < 0){
+                free(ptr);
+                return;
+            }
+            deallocate_unlocked(id, reinterpret_cast<uint8_t*>(ptr) - header_size);
+        }
+
+        // end of a level: its chunks become available to any level
+        // a chunk still holding buffers of the level (e.g. kept by an in-memory writer) is reused once they are freed
+        void release_level(int level){
+            std::lock_guard<std::mutex> lock(mutex);
+            current.erase(level);
+        }
+
+        // live buffers allocated while the level was active
+        size_t live_buffers(int level) const {
+            std::lock_guard<std::mutex> lock(mutex);
+            size_t num_live = 0;
+            for(const auto& c:chunks){
+                if(c.level == level) num_live += c.num_live;
+            }
+            return num_live;
+        }
+
+        // return all chunks to the system, every buffer of the arena must have been freed
+        void release(){
+            std::lock_guard<std::mutex> lock(mutex);
+            size_t num_live = 0;
+            for(const auto& c:chunks) num_live += c.num_live;
+            if(num_live){
+                std::cerr << "ArenaAllocator: releasing with " << num_live << " live buffers" << std::endl;
+            }
+            for(auto& c:chunks) free(c.data);
+            chunks.clear();
+            chunk_ids.clear();
+            current.clear();
+        }
+
+        size_t reserved() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            size_t total = 0;
+            for(const auto& c:chunks) total += c.size;
+            return total;
+        }
+
+        size_t live_buffers() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            size_t num_live = 0;
+            for(const auto& c:chunks) num_live += c.num_live;
+            return num_live;
+        }
+
+        void print() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            size_t total = 0;
+            for(const auto& c:chunks) total += c.size;
+            std::cout << "Arena allocator with " << chunks.size() << " chunks, " << total << " bytes reserved." << std::endl;
+        }
+    private:
+        struct Chunk{
+            uint8_t * data;
+            size_t size;
+            // bump pointer, start of the most recent buffer (NO_LAST if it was freed) and number of live buffers
+            size_t offset;
+            size_t last;
+            size_t num_live;
+            // level the chunk was last handed to
+            int level;
+        };
+
+        // every buffer is preceded by its requested size, keeps the buffers 16-byte aligned
+        static const size_t header_size = 16;
+        static const size_t NO_LAST = (size_t) -1;
+
+        static std::mutex& registry_mutex(){
+            static std::mutex m;
+            return m;
+        }
+        static std::vector<ArenaAllocator *>& registry(){
+            static std::vector<ArenaAllocator *> arenas;
+            return arenas;
+        }
+        // skips the registry lock while no arena is alive
+        static std::atomic<int>& num_arenas(){
+            static std::atomic<int> count{0};
+            return count;
+        }
+
+        static size_t align(size_t size){
+            return (size + 15) & ~((size_t) 15);
+        }
+
+        static size_t& header(uint8_t * block){
+            return *reinterpret_cast<size_t*>(block);
+        }
+
+        // chunk holding ptr, -1 if not allocated by the arena
+        // a zero-sized buffer may end exactly at the end of its chunk
+        int find_chunk(const void * ptr) const {
+            const uint8_t * p = reinterpret_cast<const uint8_t*>(ptr);
+            auto it = chunk_ids.lower_bound(p);
+            if(it == chunk_ids.begin()) return -1;
+            -- it;
+            const Chunk& c = chunks[it->second];
+            return (p > c.data && p <= c.data + c.size) ? it->second : -1;
+        }
+
+        // chunk currently bumped by some level
+        bool is_current(int id) const {
+            for(const auto& l:current){
+                if(l.second == id) return true;
+            }
+            return false;
+        }
+
+        void * allocate_unlocked(size_t size){
+            const size_t need = header_size + align(size);
+            const int level = MemoryTracker::current_level();
+            auto it = current.find(level);
+            int id = (it == current.end()) ? -1 : it->second;
+            if(id < 0 || chunks[id].offset + need > chunks[id].size){
+                // switch to an empty chunk that is large enough and not used by another level, or append a new one
+                id = -1;
+                for(int i=0; i<chunks.size(); i++){
+                    if(chunks[i].num_live == 0 && chunks[i].size >= need && !is_current(i)){
+                        id = i;
+                        break;
+                    }
+                }
+                if(id < 0){
+                    size_t size_chunk = std::max(chunk_size, need);
+                    uint8_t * data = (uint8_t *) malloc(size_chunk);
+                    if(data == NULL) return NULL;
+                    id = chunks.size();
+                    chunks.push_back(Chunk{data, size_chunk, 0, NO_LAST, 0, level});
+                    chunk_ids[data] = id;
+                }
+                chunks[id].offset = 0;
+                chunks[id].last = NO_LAST;
+                chunks[id].level = level;
+                current[level] = id;
+            }
+            Chunk& c = chunks[id];
+            uint8_t * block = c.data + c.offset;
+            header(block) = size;
+            c.last = c.offset;
+            c.offset += need;
+            c.num_live ++;
+            return block + header_size;
+        }
+
+        void deallocate_unlocked(int id, uint8_t * block){
+            Chunk& c = chunks[id];
+            c.num_live --;
+            if(c.num_live == 0){
+                // everything in the chunk is freed: rewind it
+                c.offset = 0;
+                c.last = NO_LAST;
+            }
+            else if(c.last != NO_LAST && block == c.data + c.last){
+                c.offset = c.last;
+                c.last = NO_LAST;
+            }
+        }
+
+        size_t chunk_size;
+        mutable std::mutex mutex;
+        std::vector<Chunk> chunks;
+        std::map<const uint8_t *, int> chunk_ids;
+        // chunk bumped by each level
+        std::map<int, int> current;
+    };
+}
+#endif
@@ -0,0 +1,31 @@
+#ifndef _MDR_MALLOC_ALLOCATOR_HPP
+#define _MDR_MALLOC_ALLOCATOR_HPP
+
+#include "AllocatorInterface.hpp"
+#include <cstdlib>
+#include <iostream>
+
+namespace MDR {
+    // Default allocator: plain malloc/realloc/free
+    class MallocAllocator : public concepts::AllocatorInterface {
+    public:
+        MallocAllocator(){}
+
+        void * allocate(size_t size){
+            return malloc(size);
+        }
+
+        void * reallocate(void * ptr, size_t size){
+            return realloc(ptr, size);
+        }
+
+        void deallocate(void * ptr){
+            free(ptr);
+        }
+
+        void print() const {
+            std::cout << "Malloc allocator." << std::endl;
+        }
+    };
+}
+#endif
@@ -0,0 +1,208 @@
+#ifndef _MDR_MEMORY_TRACKER_HPP
+#define _MDR_MEMORY_TRACKER_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+
+namespace MDR {
+    // Live and peak bytes of the buffers allocated by one stage (or all stages)
+    struct MemoryStats{
+        int64_t current = 0;
+        int64_t peak = 0;
+        uint64_t allocated = 0;
+        uint64_t num_allocations = 0;
+
+        void add(int64_t size){
+            current += size;
+            if(current > peak) peak = current;
+        }
+    };
+
+    // Process-wide accounting of the buffers allocated through MDR::allocate
+    // each buffer is charged to the (stage, level) active on the allocating thread, see MemoryScope,
+    // and released from it whichever stage frees it; buffers allocated outside any scope are charged to "other"
+    // disabled by default; setting MDR_MEMORY=<file> enables it at startup and writes a JSON report at exit
+    class MemoryTracker {
+    public:
+        static MemoryTracker& instance(){
+            static MemoryTracker tracker;
+            return tracker;
+        }
+        MemoryTracker(const MemoryTracker&) = delete;
+        MemoryTracker& operator=(const MemoryTracker&) = delete;
+
+        void enable(bool on = true){
+            active.store(on, std::memory_order_relaxed);
+        }
+
+        bool enabled() const {
+            return active.load(std::memory_order_relaxed);
+        }
+
+        void on_allocate(void * ptr, size_t size){
+            if(ptr == NULL) return;
+            std::lock_guard<std::mutex> lock(mutex);
+            int id = stage_id(current_stage(), current_level());
+            buffers[ptr] = Buffer{(uint64_t) size, id};
+            charge(id, size);
+            stage_stats[id].allocated += size;
+            stage_stats[id].num_allocations ++;
+            total_stats.allocated += size;
+            total_stats.num_allocations ++;
+        }
+
+        // buffers not allocated while tracking are ignored
+        void on_deallocate(void * ptr){
+            if(ptr == NULL) return;
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = buffers.find(ptr);
+            if(it == buffers.end()) return;
+            charge(it->second.stage, - (int64_t) it->second.size);
+            buffers.erase(it);
+        }
+
+        void on_reallocate(void * old_ptr, void * ptr, size_t size){
+            on_deallocate(old_ptr);
+            on_allocate(ptr, size);
+        }
+
+        MemoryStats total() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return total_stats;
+        }
+
+        // statistics per (stage, level)
+        std::map<std::pair<std::string, int>, MemoryStats> stages() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::map<std::pair<std::string, int>, MemoryStats> result;
+            for(int i=0; i<stage_keys.size(); i++){
+                result[stage_keys[i]] = stage_stats[i];
+            }
+            return result;
+        }
+
+        // live bytes of every (stage, level) when the total peak was reached
+        std::map<std::pair<std::string, int>, int64_t> peak_breakdown() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::map<std::pair<std::string, int>, int64_t> result;
+            for(int i=0; i<peak_snapshot.size(); i++){
+                if(peak_snapshot[i]) result[stage_keys[i]] = peak_snapshot[i];
+            }
+            return result;
+        }
+
+        void reset(){
+            std::lock_guard<std::mutex> lock(mutex);
+            buffers.clear();
+            stage_keys.clear();
+            stage_ids.clear();
+            stage_stats.clear();
+            peak_snapshot.clear();
+            total_stats = MemoryStats();
+        }
+
+        void write_json(std::ostream& out) const {
+            MemoryStats t = total();
+            auto all_stages = stages();
+            auto breakdown = peak_breakdown();
+            out << "{\"total\":{\"current\":" << t.current << ",\"peak\":" << t.peak << ",\"allocated\":" << t.allocated << ",\"num_allocations\":" << t.num_allocations << "},\n\"stages\":[";
+            bool first = true;
+            for(const auto& s:all_stages){
+                auto b = breakdown.find(s.first);
+                out << (first ? "" : ",") << "\n{\"stage\":\"" << s.first.first << "\",\"level\":" << s.first.second << ",\"current\":" << s.second.current << ",\"peak\":" << s.second.peak
+                    << ",\"at_total_peak\":" << ((b == breakdown.end()) ? 0 : b->second) << ",\"allocated\":" << s.second.allocated << ",\"num_allocations\":" << s.second.num_allocations << "}";
+                first = false;
+            }
+            out << "]}" << std::endl;
+        }
+
+        // attribution context of the calling thread
+        static const char *& current_stage(){
+            static thread_local const char * stage = "other";
+            return stage;
+        }
+        static int& current_level(){
+            static thread_local int level = -1;
+            return level;
+        }
+
+        ~MemoryTracker(){
+            if(output_file.empty()) return;
+            std::ofstream out(output_file);
+            if(out) write_json(out);
+            else std::cerr << "Errors in writing memory report to " << output_file << std::endl;
+        }
+    private:
+        struct Buffer{
+            uint64_t size;
+            int stage;
+        };
+
+        MemoryTracker(){
+            const char * env = getenv("MDR_MEMORY");
+            if(env && *env){
+                output_file = env;
+                active = true;
+            }
+        }
+
+        int stage_id(const char * stage, int level){
+            auto key = std::make_pair(std::string(stage), level);
+            auto it = stage_ids.find(key);
+            if(it != stage_ids.end()) return it->second;
+            int id = stage_keys.size();
+            stage_ids[key] = id;
+            stage_keys.push_back(key);
+            stage_stats.push_back(MemoryStats());
+            return id;
+        }
+
+        void charge(int id, int64_t size){
+            stage_stats[id].add(size);
+            int64_t prev_peak = total_stats.peak;
+            total_stats.add(size);
+            if(total_stats.peak > prev_peak){
+                peak_snapshot.resize(stage_stats.size());
+                for(int i=0; i<stage_stats.size(); i++) peak_snapshot[i] = stage_stats[i].current;
+            }
+        }
+
+        std::atomic<bool> active{false};
+        std::string output_file;
+        mutable std::mutex mutex;
+        std::unordered_map<void *, Buffer> buffers;
+        std::vector<std::pair<std::string, int>> stage_keys;
+        std::map<std::pair<std::string, int>, int> stage_ids;
+        std::vector<MemoryStats> stage_stats;
+        std::vector<int64_t> peak_snapshot;
+        MemoryStats total_stats;
+    };
+
+    // Charge the buffers allocated by the calling thread in this scope to a stage and level
+    class MemoryScope {
+    public:
+        MemoryScope(const char * stage, int level = -1) : prev_stage(MemoryTracker::current_stage()), prev_level(MemoryTracker::current_level()) {
+            MemoryTracker::current_stage() = stage;
+            MemoryTracker::current_level() = level;
+        }
+        MemoryScope(const MemoryScope&) = delete;
+        MemoryScope& operator=(const MemoryScope&) = delete;
+
+        ~MemoryScope(){
+            MemoryTracker::current_stage() = prev_stage;
+            MemoryTracker::current_level() = prev_level;
+        }
+    private:
+        const char * prev_stage;
+        int prev_level;
+    };
+}
+#endif
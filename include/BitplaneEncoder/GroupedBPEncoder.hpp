@@ -2,6 +2,7 @@
 #define _MDR_GROUPED_BP_ENCODER_HPP
 
 #include "BitplaneEncoderInterface.hpp"
+#include "Allocator/Allocator.hpp"
 
 namespace MDR {
     // general bitplane encoder that encodes data by block using T_stream type buffer
@@ -15,17 +16,17 @@ namespace MDR {
             static_assert(std::is_integral<T_stream>::value, "GroupedBPBlockEncoder: streams must be unsigned integers.");
         }
 
-        std::vector<uint8_t *> encode(T_data const * data, int32_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint32_t>& stream_sizes) const {
+        std::vector<uint8_t *> encode(T_data const * data, size_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint64_t>& stream_sizes) const {
             assert(num_bitplanes > 0);
             // determine block size based on bitplane integer type
             uint32_t block_size = block_size_based_on_bitplane_int_type<T_stream>();
             std::vector<uint8_t> starting_bitplanes = std::vector<uint8_t>((n - 1)/block_size + 1, 0);
-            stream_sizes = std::vector<uint32_t>(num_bitplanes, 0);
+            stream_sizes = std::vector<uint64_t>(num_bitplanes, 0);
             // define fixed point type
             using T_fp = typename std::conditional<std::is_same<T_data, double>::value, uint64_t, uint32_t>::type;
             std::vector<uint8_t *> streams;
             for(int i=0; i<num_bitplanes; i++){
-                streams.push_back((uint8_t *) malloc(2 * n / UINT8_BITS + sizeof(T_stream)));
+                streams.push_back((uint8_t *) allocate(2 * n / UINT8_BITS + sizeof(T_stream)));
             }
             std::vector<T_fp> int_data_buffer(block_size, 0);
             std::vector<T_stream *> streams_pos(streams.size());
@@ -33,8 +34,8 @@ namespace MDR {
                 streams_pos[i] = reinterpret_cast<T_stream*>(streams[i]);
             }
             T_data const * data_pos = data;
-            int block_id=0;
-            for(int i=0; i<n - block_size; i+=block_size){
+            size_t block_id = 0;
+            for(size_t i=0; i + block_size < n; i+=block_size){
                 T_stream sign_bitplane = 0;
                 for(int j=0; j<block_size; j++){
                     T_data cur_data = *(data_pos++);
@@ -64,26 +65,26 @@ namespace MDR {
                 stream_sizes[i] = reinterpret_cast<uint8_t*>(streams_pos[i]) - streams[i];
             }
             // merge starting_bitplane with the first bitplane
-            uint32_t merged_size = 0;
+            uint64_t merged_size = 0;
             uint8_t * merged = merge_arrays(reinterpret_cast<uint8_t const*>(starting_bitplanes.data()), starting_bitplanes.size() * sizeof(uint8_t), reinterpret_cast<uint8_t*>(streams[0]), stream_sizes[0], merged_size);
-            free(streams[0]);
+            deallocate(streams[0]);
             streams[0] = merged;
             stream_sizes[0] = merged_size;
             return streams;
         }
 
         // only differs in error collection
-        std::vector<uint8_t *> encode(T_data const * data, int32_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint32_t>& stream_sizes, std::vector<double>& level_errors) const {
+        std::vector<uint8_t *> encode(T_data const * data, size_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint64_t>& stream_sizes, std::vector<double>& level_errors) const {
             assert(num_bitplanes > 0);
             // determine block size based on bitplane integer type
             uint32_t block_size = block_size_based_on_bitplane_int_type<T_stream>();
             std::vector<uint8_t> starting_bitplanes = std::vector<uint8_t>((n - 1)/block_size + 1, 0);
-            stream_sizes = std::vector<uint32_t>(num_bitplanes, 0);
+            stream_sizes = std::vector<uint64_t>(num_bitplanes, 0);
             // define fixed point type
             using T_fp = typename std::conditional<std::is_same<T_data, double>::value, uint64_t, uint32_t>::type;
             std::vector<uint8_t *> streams;
             for(int i=0; i<num_bitplanes; i++){
-                streams.push_back((uint8_t *) malloc(2 * n / UINT8_BITS + sizeof(T_stream)));
+                streams.push_back((uint8_t *) allocate(2 * n / UINT8_BITS + sizeof(T_stream)));
             }
             std::vector<T_fp> int_data_buffer(block_size, 0);
             std::vector<T_stream *> streams_pos(streams.size());
@@ -97,8 +98,8 @@ namespace MDR {
                 level_errors[i] = 0;
             }
             T_data const * data_pos = data;
-            int block_id=0;
-            for(int i=0; i<n - block_size; i+=block_size){
+            size_t block_id = 0;
+            for(size_t i=0; i + block_size < n; i+=block_size){
                 T_stream sign_bitplane = 0;
                 for(int j=0; j<block_size; j++){
                     T_data cur_data = *(data_pos++);
@@ -132,9 +133,9 @@ namespace MDR {
                 stream_sizes[i] = reinterpret_cast<uint8_t*>(streams_pos[i]) - streams[i];
             }
             // merge starting_bitplane with the first bitplane
-            uint32_t merged_size = 0;
+            uint64_t merged_size = 0;
             uint8_t * merged = merge_arrays(reinterpret_cast<uint8_t const*>(starting_bitplanes.data()), starting_bitplanes.size() * sizeof(uint8_t), reinterpret_cast<uint8_t*>(streams[0]), stream_sizes[0], merged_size);
-            free(streams[0]);
+            deallocate(streams[0]);
             streams[0] = merged;
             stream_sizes[0] = merged_size;
             // translate level errors
@@ -144,11 +145,11 @@ namespace MDR {
             return streams;
         }
 
-        T_data * decode(const std::vector<uint8_t const *>& streams, int32_t n, int exp, uint8_t num_bitplanes) {
+        T_data * decode(const std::vector<uint8_t const *>& streams, size_t n, int exp, uint8_t num_bitplanes) {
             uint32_t block_size = block_size_based_on_bitplane_int_type<T_stream>();
             // define fixed point type
             using T_fp = typename std::conditional<std::is_same<T_data, double>::value, uint64_t, uint32_t>::type;
-            T_data * data = (T_data *) malloc(n * sizeof(T_data));
+            T_data * data = (T_data *) allocate(n * sizeof(T_data));
             if(num_bitplanes == 0){
                 memset(data, 0, n * sizeof(T_data));
                 return data;
@@ -165,8 +166,8 @@ namespace MDR {
             std::vector<T_fp> int_data_buffer(block_size, 0);
             // decode
             T_data * data_pos = data;
-            int block_id = 0;
-            for(int i=0; i<n - block_size; i+=block_size){
+            size_t block_id = 0;
+            for(size_t i=0; i + block_size < n; i+=block_size){
                 uint8_t recording_bitplane = recording_bitplanes[block_id ++];
                 if(recording_bitplane < num_bitplanes){
                     memset(int_data_buffer.data(), 0, block_size * sizeof(T_fp));
@@ -207,11 +208,11 @@ namespace MDR {
         }
 
         // decode the data and record necessary information for progressiveness
-        T_data * progressive_decode(const std::vector<uint8_t const *>& streams, int32_t n, int exp, uint8_t starting_bitplane, uint8_t num_bitplanes, int level) {
+        T_data * progressive_decode(const std::vector<uint8_t const *>& streams, size_t n, int exp, uint8_t starting_bitplane, uint8_t num_bitplanes, int level) {
             uint32_t block_size = block_size_based_on_bitplane_int_type<T_stream>();
             // define fixed point type
             using T_fp = typename std::conditional<std::is_same<T_data, double>::value, uint64_t, uint32_t>::type;
-            T_data * data = (T_data *) malloc(n * sizeof(T_data));
+            T_data * data = (T_data *) allocate(n * sizeof(T_data));
             if(num_bitplanes == 0){
                 memset(data, 0, n * sizeof(T_data));
                 return data;
@@ -238,8 +239,8 @@ namespace MDR {
             const uint8_t ending_bitplane = starting_bitplane + num_bitplanes;
             // decode
             T_data * data_pos = data;
-            int block_id = 0;
-            for(int i=0; i<n - block_size; i+=block_size){
+            size_t block_id = 0;
+            for(size_t i=0; i + block_size < n; i+=block_size){
                 uint8_t recording_bitplane = recording_bitplanes[block_id ++];
                 if(recording_bitplane < ending_bitplane){
                     memset(int_data_buffer.data(), 0, block_size * sizeof(T_fp));
@@ -367,9 +368,9 @@ namespace MDR {
             }
         }
 
-        uint8_t * merge_arrays(uint8_t const * array1, uint32_t size1, uint8_t const * array2, uint32_t size2, uint32_t& merged_size) const {
+        uint8_t * merge_arrays(uint8_t const * array1, uint32_t size1, uint8_t const * array2, uint64_t size2, uint64_t& merged_size) const {
             merged_size = sizeof(uint32_t) + size1 + size2;
-            uint8_t * merged_array = (uint8_t *) malloc(merged_size);
+            uint8_t * merged_array = (uint8_t *) allocate(merged_size);
             *reinterpret_cast<uint32_t*>(merged_array) = size1;
             memcpy(merged_array + sizeof(uint32_t), array1, size1);
             memcpy(merged_array + sizeof(uint32_t) + size1, array2, size2);
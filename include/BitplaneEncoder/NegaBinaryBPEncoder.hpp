@@ -2,6 +2,7 @@
 #define _MDR_NEGABINARY_BP_ENCODER_HPP
 
 #include "BitplaneEncoderInterface.hpp"
+#include "Allocator/Allocator.hpp"
 
 namespace MDR {
     // general bitplane encoder that encodes data by block using T_stream type buffer
@@ -15,20 +16,20 @@ namespace MDR {
             static_assert(std::is_integral<T_stream>::value, "NegaBinaryEncoder: streams must be unsigned integers.");
         }
 
-        std::vector<uint8_t *> encode(T_data const * data, int32_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint32_t>& stream_sizes) const {
+        std::vector<uint8_t *> encode(T_data const * data, size_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint64_t>& stream_sizes) const {
             assert(num_bitplanes > 0);
             // leave room for negabinary format
             exp += 2;
             // determine block size based on bitplane integer type
             uint32_t block_size = block_size_based_on_bitplane_int_type<T_stream>();
             std::vector<uint8_t> starting_bitplanes = std::vector<uint8_t>((n - 1)/block_size + 1, 0);
-            stream_sizes = std::vector<uint32_t>(num_bitplanes, 0);
+            stream_sizes = std::vector<uint64_t>(num_bitplanes, 0);
             // define fixed point type
             using T_fps = typename std::conditional<std::is_same<T_data, double>::value, int64_t, int32_t>::type;
             using T_fp = typename std::conditional<std::is_same<T_data, double>::value, uint64_t, uint32_t>::type;
             std::vector<uint8_t *> streams;
             for(int i=0; i<num_bitplanes; i++){
-                streams.push_back((uint8_t *) malloc(n / UINT8_BITS + sizeof(T_stream)));
+                streams.push_back((uint8_t *) allocate(n / UINT8_BITS + sizeof(T_stream)));
             }
             std::vector<T_fp> int_data_buffer(block_size, 0);
             std::vector<T_stream *> streams_pos(streams.size());
@@ -36,7 +37,7 @@ namespace MDR {
                 streams_pos[i] = reinterpret_cast<T_stream*>(streams[i]);
             }
             T_data const * data_pos = data;
-            for(int i=0; i<n - block_size; i+=block_size){
+            for(size_t i=0; i + block_size < n; i+=block_size){
                 for(int j=0; j<block_size; j++){
                     T_data cur_data = *(data_pos++);
                     T_data shifted_data = ldexp(cur_data, num_bitplanes - exp);
@@ -62,20 +63,20 @@ namespace MDR {
         }
 
         // only differs in error collection
-        std::vector<uint8_t *> encode(T_data const * data, int32_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint32_t>& stream_sizes, std::vector<double>& level_errors) const {
+        std::vector<uint8_t *> encode(T_data const * data, size_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint64_t>& stream_sizes, std::vector<double>& level_errors) const {
             assert(num_bitplanes > 0);
             // leave room for negabinary format
             exp += 2;
             // determine block size based on bitplane integer type
             uint32_t block_size = block_size_based_on_bitplane_int_type<T_stream>();
             std::vector<uint8_t> starting_bitplanes = std::vector<uint8_t>((n - 1)/block_size + 1, 0);
-            stream_sizes = std::vector<uint32_t>(num_bitplanes, 0);
+            stream_sizes = std::vector<uint64_t>(num_bitplanes, 0);
             // define fixed point type
             using T_fps = typename std::conditional<std::is_same<T_data, double>::value, int64_t, int32_t>::type;
             using T_fp = typename std::conditional<std::is_same<T_data, double>::value, uint64_t, uint32_t>::type;
             std::vector<uint8_t *> streams;
             for(int i=0; i<num_bitplanes; i++){
-                streams.push_back((uint8_t *) malloc(n / UINT8_BITS + sizeof(T_stream)));
+                streams.push_back((uint8_t *) allocate(n / UINT8_BITS + sizeof(T_stream)));
             }
             std::vector<T_fp> int_data_buffer(block_size, 0);
             std::vector<T_stream *> streams_pos(streams.size());
@@ -89,7 +90,7 @@ namespace MDR {
                 level_errors[i] = 0;
             }
             T_data const * data_pos = data;
-            for(int i=0; i<n - block_size; i+=block_size){
+            for(size_t i=0; i + block_size < n; i+=block_size){
                 for(int j=0; j<block_size; j++){
                     T_data cur_data = *(data_pos++);
                     T_data shifted_data = ldexp(cur_data, num_bitplanes - exp);
@@ -124,14 +125,14 @@ namespace MDR {
             return streams;
         }
 
-        T_data * decode(const std::vector<uint8_t const *>& streams, int32_t n, int exp, uint8_t num_bitplanes) {
+        T_data * decode(const std::vector<uint8_t const *>& streams, size_t n, int exp, uint8_t num_bitplanes) {
             return progressive_decode(streams, n, exp, 0, num_bitplanes, streams.size());
         }
 
         // decode the data and record necessary information for progressiveness
-        T_data * progressive_decode(const std::vector<uint8_t const *>& streams, int32_t n, int exp, uint8_t starting_bitplane, uint8_t num_bitplanes, int level) {
+        T_data * progressive_decode(const std::vector<uint8_t const *>& streams, size_t n, int exp, uint8_t starting_bitplane, uint8_t num_bitplanes, int level) {
             uint32_t block_size = block_size_based_on_bitplane_int_type<T_stream>();
-            T_data * data = (T_data *) malloc(n * sizeof(T_data));
+            T_data * data = (T_data *) allocate(n * sizeof(T_data));
             if(num_bitplanes == 0){
                 memset(data, 0, n * sizeof(T_data));
                 return data;
@@ -151,7 +152,7 @@ namespace MDR {
             T_data * data_pos = data;
             // std::cout << "ending_bitplane = " << +ending_bitplane << std::endl;
             if(ending_bitplane % 2 == 0){
-                for(int i=0; i<n - block_size; i+=block_size){
+                for(size_t i=0; i + block_size < n; i+=block_size){
                     memset(int_data_buffer.data(), 0, block_size * sizeof(T_fp));
                     decode_block(streams_pos, block_size, num_bitplanes, int_data_buffer.data());
                     for(int j=0; j<block_size; j++){
@@ -170,7 +171,7 @@ namespace MDR {
                 }                
             }
             else{
-                for(int i=0; i<n - block_size; i+=block_size){
+                for(size_t i=0; i + block_size < n; i+=block_size){
                     memset(int_data_buffer.data(), 0, block_size * sizeof(T_fp));
                     decode_block(streams_pos, block_size, num_bitplanes, int_data_buffer.data());
                     for(int j=0; j<block_size; j++){
@@ -2,6 +2,7 @@
 #define _MDR_PERBIT_BP_ENCODER_HPP
 
 #include "BitplaneEncoderInterface.hpp"
+#include "Allocator/Allocator.hpp"
 #include <bitset>
 namespace MDR {
     class BitEncoder{
@@ -28,7 +29,7 @@ namespace MDR {
                 position = 0;
             }
         }
-        uint32_t size(){
+        size_t size(){
             return (stream_pos - stream_begin);
         }
     private:
@@ -56,7 +57,7 @@ namespace MDR {
             position --;
             return b;
         }
-        uint32_t size(){
+        size_t size(){
             return (stream_pos - stream_begin);
         }
     private:
@@ -78,23 +79,23 @@ namespace MDR {
             static_assert(std::is_integral<T_stream>::value, "PerBitBPEncoder: streams must be unsigned integers.");
         }
 
-        std::vector<uint8_t *> encode(T_data const * data, int32_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint32_t>& stream_sizes) const {
+        std::vector<uint8_t *> encode(T_data const * data, size_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint64_t>& stream_sizes) const {
             assert(num_bitplanes > 0);
             // determine block size based on bitplane integer type
             const int32_t block_size = PER_BIT_BLOCK_SIZE;
-            stream_sizes = std::vector<uint32_t>(num_bitplanes, 0);
+            stream_sizes = std::vector<uint64_t>(num_bitplanes, 0);
             // define fixed point type
             using T_fp = typename std::conditional<std::is_same<T_data, double>::value, uint64_t, uint32_t>::type;
             std::vector<uint8_t *> streams;
             for(int i=0; i<num_bitplanes; i++){
-                streams.push_back((uint8_t *) malloc(2 * n / UINT8_BITS + sizeof(uint64_t)));
+                streams.push_back((uint8_t *) allocate(2 * n / UINT8_BITS + sizeof(uint64_t)));
             }
             std::vector<BitEncoder> encoders;
             for(int i=0; i<streams.size(); i++){
                 encoders.push_back(BitEncoder(reinterpret_cast<uint64_t*>(streams[i])));
             }
             T_data const * data_pos = data;
-            for(int i=0; i<n - block_size; i+=block_size){
+            for(size_t i=0; i + block_size < n; i+=block_size){
                 T_stream sign_bitplane = 0;
                 for(int j=0; j<block_size; j++){
                     T_data cur_data = *(data_pos++);
@@ -146,16 +147,16 @@ namespace MDR {
         }
 
         // only differs in error collection
-        std::vector<uint8_t *> encode(T_data const * data, int32_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint32_t>& stream_sizes, std::vector<double>& level_errors) const {
+        std::vector<uint8_t *> encode(T_data const * data, size_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint64_t>& stream_sizes, std::vector<double>& level_errors) const {
             assert(num_bitplanes > 0);
             // determine block size based on bitplane integer type
             const int32_t block_size = PER_BIT_BLOCK_SIZE;
-            stream_sizes = std::vector<uint32_t>(num_bitplanes, 0);
+            stream_sizes = std::vector<uint64_t>(num_bitplanes, 0);
             // define fixed point type
             using T_fp = typename std::conditional<std::is_same<T_data, double>::value, uint64_t, uint32_t>::type;
             std::vector<uint8_t *> streams;
             for(int i=0; i<num_bitplanes; i++){
-                streams.push_back((uint8_t *) malloc(2 * n / UINT8_BITS + sizeof(uint64_t)));
+                streams.push_back((uint8_t *) allocate(2 * n / UINT8_BITS + sizeof(uint64_t)));
             }
             std::vector<BitEncoder> encoders;
             for(int i=0; i<streams.size(); i++){
@@ -168,7 +169,7 @@ namespace MDR {
                 level_errors[i] = 0;
             }
             T_data const * data_pos = data;
-            for(int i=0; i<n - block_size; i+=block_size){
+            for(size_t i=0; i + block_size < n; i+=block_size){
                 T_stream sign_bitplane = 0;
                 for(int j=0; j<block_size; j++){
                     T_data cur_data = *(data_pos++);
@@ -225,11 +226,11 @@ namespace MDR {
             return streams;
         }
 
-        T_data * decode(const std::vector<uint8_t const *>& streams, int32_t n, int exp, uint8_t num_bitplanes) {
+        T_data * decode(const std::vector<uint8_t const *>& streams, size_t n, int exp, uint8_t num_bitplanes) {
             const int32_t block_size = PER_BIT_BLOCK_SIZE;
             // define fixed point type
             using T_fp = typename std::conditional<std::is_same<T_data, double>::value, uint64_t, uint32_t>::type;
-            T_data * data = (T_data *) malloc(n * sizeof(T_data));
+            T_data * data = (T_data *) allocate(n * sizeof(T_data));
             if(num_bitplanes == 0){
                 memset(data, 0, n * sizeof(T_data));
                 return data;
@@ -241,7 +242,7 @@ namespace MDR {
             }
             // decode
             T_data * data_pos = data;
-            for(int i=0; i<n - block_size; i+=block_size){
+            for(size_t i=0; i + block_size < n; i+=block_size){
                 for(int j=0; j<block_size; j++){
                     T_fp fp_data = 0;
                     // decode each bit of the data for each level component
@@ -287,11 +288,11 @@ namespace MDR {
             return data;
         }
 
-        T_data * progressive_decode(const std::vector<uint8_t const *>& streams, int32_t n, int exp, uint8_t starting_bitplane, uint8_t num_bitplanes, int level) {
+        T_data * progressive_decode(const std::vector<uint8_t const *>& streams, size_t n, int exp, uint8_t starting_bitplane, uint8_t num_bitplanes, int level) {
             const int32_t block_size = PER_BIT_BLOCK_SIZE;
             // define fixed point type
             using T_fp = typename std::conditional<std::is_same<T_data, double>::value, uint64_t, uint32_t>::type;
-            T_data * data = (T_data *) malloc(n * sizeof(T_data));
+            T_data * data = (T_data *) allocate(n * sizeof(T_data));
             if(num_bitplanes == 0){
                 memset(data, 0, n * sizeof(T_data));
                 return data;
@@ -310,7 +311,7 @@ namespace MDR {
             const uint8_t ending_bitplane = starting_bitplane + num_bitplanes;
             // decode
             T_data * data_pos = data;
-            for(int i=0; i<n - block_size; i+=block_size){
+            for(size_t i=0; i + block_size < n; i+=block_size){
                 for(int j=0; j<block_size; j++){
                     T_fp fp_data = 0;
                     // decode each bit of the data for each level component
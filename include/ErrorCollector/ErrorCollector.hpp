@@ -3,5 +3,6 @@
 
 #include "MaxErrorCollector.hpp"
 #include "SquaredErrorCollector.hpp"
+#include "HistogramErrorCollector.hpp"
 
 #endif
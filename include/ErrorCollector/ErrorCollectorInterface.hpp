@@ -13,6 +13,9 @@ namespace MDR {
 
             virtual std::vector<double> collect_level_error(T const * data, size_t n, int num_bitplanes, T max_level_error) const = 0;
 
+            // approximate collectors replace the exact squared errors collected by the encoder during refactoring
+            virtual bool approximate() const = 0;
+
             virtual void print() const = 0;
         };
     }
@@ -0,0 +1,154 @@
+#ifndef _MDR_HISTOGRAM_ERROR_COLLECTOR_HPP
+#define _MDR_HISTOGRAM_ERROR_COLLECTOR_HPP
+
+#include "ErrorCollectorInterface.hpp"
+#include "SquaredErrorCollector.hpp"
+#include "ThreadPool.hpp"
+#include <cmath>
+#include <future>
+#include <algorithm>
+
+namespace MDR {
+    // approximate s-norm error collector: upper bound of the sum of squared errors from a histogram
+    // values are counted per (exponent relative to the level, leading mantissa_bits bits of the mantissa),
+    // one increment per value; the error of each bin is bounded by its largest possible truncation remainder,
+    // so the result is a guaranteed upper bound of SquaredErrorCollector, tighter with more mantissa bits
+    // with sample_stride > 1 only every sample_stride-th value is counted and counts are scaled,
+    // which makes the bound statistical instead of guaranteed
+    // approximate collectors replace the exact errors collected by the encoder during refactoring;
+    // the bound assumes sign-magnitude truncation (GroupedBPEncoder, PerBitBPEncoder), not negabinary digits
+    template<class T>
+    class HistogramErrorCollector : public concepts::ErrorCollectorInterface<T> {
+    public:
+        HistogramErrorCollector(int mantissa_bits = 4, size_t sample_stride = 1, int num_threads = std::thread::hardware_concurrency())
+            : mantissa_bits(std::min(std::max(mantissa_bits, 0), prec)), sample_stride(std::max<size_t>(sample_stride, 1)), num_threads(std::max(1, num_threads)) {
+            static_assert(std::is_floating_point<T>::value, "HistogramErrorCollector: input data must be floating points.");
+            static_assert(!std::is_same<T, long double>::value, "HistogramErrorCollector: long double is not supported.");
+        }
+        std::vector<double> collect_level_error(T const * data, size_t n, int num_bitplanes, T max_level_error) const {
+            int level_exp = 0;
+            frexp(max_level_error, &level_exp);
+            const int encode_prec = num_bitplanes;
+            std::vector<double> squared_error = std::vector<double>(num_bitplanes + 1, 0);
+            if(n == 0) return squared_error;
+
+            const size_t num_samples = (n + sample_stride - 1) / sample_stride;
+            const int num_parts = (num_samples < min_samples_per_thread * 2) ? 1 : std::min<size_t>(num_threads, num_samples / min_samples_per_thread);
+            std::vector<Histogram> parts(num_parts, Histogram(encode_prec, mantissa_bits));
+            if(num_parts == 1){
+                accumulate(data, 0, num_samples, level_exp, parts[0]);
+            }
+            else{
+                ThreadPool pool(num_parts);
+                std::vector<std::future<void>> tasks;
+                for(int t=0; t<num_parts; t++){
+                    size_t begin = num_samples * t / num_parts;
+                    size_t end = num_samples * (t + 1) / num_parts;
+                    tasks.push_back(pool.submit([this, data, begin, end, level_exp, &parts, t](){
+                        accumulate(data, begin, end, level_exp, parts[t]);
+                    }));
+                }
+                for(auto& task:tasks) task.get();
+            }
+            for(int t=1; t<num_parts; t++) parts[0].merge(parts[t]);
+            const Histogram& histogram = parts[0];
+            const double scale = (double) n / num_samples;
+
+            // bin (d, p): exponent level_exp - d, mantissa 2^prec + p * 2^L + r with r < 2^L unknown
+            // with k bitplanes, the c = d + prec + 1 - k trailing bits are lost and (M mod 2^c) <= (P mod 2^c) + 2^min(c, L) - 1
+            const int L = prec - mantissa_bits;
+            const uint64_t num_prefixes = (uint64_t) 1 << mantissa_bits;
+            for(int d=-prec; d<encode_prec; d++){
+                const uint64_t * counts = histogram.bin(d);
+                const int scale_exp = 2 * (level_exp - d - 1 - prec);
+                for(uint64_t p=0; p<num_prefixes; p++){
+                    if(counts[p] == 0) continue;
+                    const double count = counts[p] * scale;
+                    const double known = ldexp(1.0, prec) + ldexp((double) p, L);
+                    for(int k=0; k<=encode_prec; k++){
+                        int c = d + prec + 1 - k;
+                        if(c <= 0) break;
+                        double remainder = (c > prec) ? known + ldexp(1.0, L) - 1 : fmod(known, ldexp(1.0, c)) + ldexp(1.0, std::min(c, L)) - 1;
+                        squared_error[k] += ldexp(count * remainder * remainder, scale_exp);
+                    }
+                }
+            }
+            // values below the last bitplane are lost entirely
+            for(int k=0; k<=encode_prec; k++){
+                squared_error[k] += histogram.below * scale;
+            }
+            return squared_error;
+        }
+        bool approximate() const {
+            return true;
+        }
+        void print() const {
+            std::cout << "Histogram error collector with " << mantissa_bits << " mantissa bits, sample stride " << sample_stride << "." << std::endl;
+        }
+    private:
+        static const int prec = std::is_same<T, double>::value ? 52 : 23;
+        static const size_t min_samples_per_thread = 1 << 18;
+        using FloatingInt = typename std::conditional<std::is_same<T, double>::value, FloatingInt64, FloatingInt32>::type;
+        using UInt = typename std::conditional<std::is_same<T, double>::value, uint64_t, uint32_t>::type;
+
+        // value counts per relative exponent and mantissa prefix, plus the squares of the values below all bitplanes
+        struct Histogram{
+            Histogram(int encode_prec, int mantissa_bits) : encode_prec(encode_prec), mantissa_bits(mantissa_bits), counts((size_t) (encode_prec + prec) << mantissa_bits, 0) {}
+
+            uint64_t * bin(int d){
+                return counts.data() + ((size_t) (d + prec) << mantissa_bits);
+            }
+            const uint64_t * bin(int d) const {
+                return counts.data() + ((size_t) (d + prec) << mantissa_bits);
+            }
+            void merge(const Histogram& other){
+                for(size_t i=0; i<counts.size(); i++) counts[i] += other.counts[i];
+                below += other.below;
+            }
+
+            int encode_prec;
+            int mantissa_bits;
+            std::vector<uint64_t> counts;
+            double below = 0;
+        };
+
+        // samples [begin, end), i.e. values begin * sample_stride, ...
+        void accumulate(T const * data, size_t begin, size_t end, int level_exp, Histogram& histogram) const {
+            const UInt mantissa_mask = (((UInt) 1) << prec) - 1;
+            const UInt exponent_mask = (sizeof(T) == 8) ? 0x7ff : 0xff;
+            const int exponent_bias = (sizeof(T) == 8) ? 1022 : 126;
+            const int L = prec - mantissa_bits;
+            FloatingInt fi;
+            for(size_t s=begin; s<end; s++){
+                const T value = data[s * sample_stride];
+                fi.f = value;
+                UInt biased_exp = (fi.i >> prec) & exponent_mask;
+                UInt mantissa = 0;
+                int data_exp = 0;
+                if(biased_exp == 0){
+                    // zero and subnormal values
+                    if(value == 0) continue;
+                    T m = frexp(fabs(value), &data_exp);
+                    mantissa = ((UInt) ldexp(m, prec + 1)) & mantissa_mask;
+                }
+                else if(biased_exp == exponent_mask) continue;
+                else{
+                    data_exp = (int) biased_exp - exponent_bias;
+                    mantissa = fi.i & mantissa_mask;
+                }
+                int d = level_exp - data_exp;
+                if(d >= histogram.encode_prec){
+                    histogram.below += (double) value * value;
+                    continue;
+                }
+                if(d < -prec) continue;
+                histogram.bin(d)[mantissa >> L] ++;
+            }
+        }
+
+        int mantissa_bits;
+        size_t sample_stride;
+        int num_threads;
+    };
+}
+#endif
@@ -23,6 +23,9 @@ namespace MDR {
             }
             return max_e;
         }
+        bool approximate() const {
+            return false;
+        }
         void print() const {
             std::cout << "Max error collector." << std::endl;
         }
@@ -2,6 +2,10 @@
 #define _MDR_SQUARED_ERROR_COLLECTOR_HPP
 
 #include "ErrorCollectorInterface.hpp"
+#include "ThreadPool.hpp"
+#include <cmath>
+#include <future>
+#include <algorithm>
 
 namespace MDR {
     union FloatingInt32{
@@ -13,59 +17,138 @@ namespace MDR {
         uint64_t i;
     };
     // s-norm error collector: collecting sum of squared errors
+    // squared_error[k] is the sum of squared errors when the first k bitplanes are retrieved,
+    // i.e. when every value is truncated below bitplane k (relative to the level exponent)
+    //
+    // dropping the c trailing bits of a value with exponent e and mantissa M (implicit bit included) gives an error of
+    // (M mod 2^c) * 2^(e - 1 - prec), so values are bucketed by their exponent relative to the level:
+    // each bucket accumulates sum (M mod 2^c)^2 for every c in a fixed-length branch-free loop,
+    // and the buckets are mapped to bitplanes and scaled once at the end
+    // values are split over num_threads threads with private buckets, reduced in thread order
     template<class T>
     class SquaredErrorCollector : public concepts::ErrorCollectorInterface<T> {
     public:
-        SquaredErrorCollector(){
+        SquaredErrorCollector(int num_threads = std::thread::hardware_concurrency()) : num_threads(std::max(1, num_threads)) {
             static_assert(std::is_floating_point<T>::value, "SquaredErrorCollector: input data must be floating points.");
             static_assert(!std::is_same<T, long double>::value, "SquaredErrorCollector: long double is not supported.");
         }
         std::vector<double> collect_level_error(T const * data, size_t n, int num_bitplanes, T max_level_error) const {
             int level_exp = 0;
             frexp(max_level_error, &level_exp);
-            const int prec = std::is_same<T, double>::value ? 52 : 23;
-            using FloatingInt = typename std::conditional<std::is_same<T, double>::value, FloatingInt64, FloatingInt32>::type;
             const int encode_prec = num_bitplanes;
             std::vector<double> squared_error = std::vector<double>(num_bitplanes + 1, 0);
-            FloatingInt fi;
-            for(int i=0; i<n; i++){
-                if(data[i] == 0) continue;
-                int data_exp = 0;
-                frexp(data[i], &data_exp);
-                T val = data[i];
-                fi.f = val;
-                int exp_diff = level_exp - data_exp + prec - encode_prec;
-                // int exp_diff = level_exp - encode_prec - data_exp + prec + 1;
-                int index = encode_prec;
-                if(exp_diff > 0){
-                    // zeroing out unrecorded bitplanes
-                    for(int b=0; b<exp_diff; b++){
-                        fi.i &= ~(1u << b);            
-                    }
-                }
-                else{
-                    // skip padding 0s (no errors)
-                    index += exp_diff;
-                    exp_diff = 0;
+            if(n == 0) return squared_error;
+
+            const int num_parts = (n < min_elements_per_thread * 2) ? 1 : std::min<size_t>(num_threads, n / min_elements_per_thread);
+            std::vector<Buckets> parts(num_parts, Buckets(encode_prec));
+            if(num_parts == 1){
+                accumulate(data, n, level_exp, parts[0]);
+            }
+            else{
+                ThreadPool pool(num_parts);
+                std::vector<std::future<void>> tasks;
+                for(int t=0; t<num_parts; t++){
+                    size_t begin = n * t / num_parts;
+                    size_t end = n * (t + 1) / num_parts;
+                    tasks.push_back(pool.submit([this, data, begin, end, level_exp, &parts, t](){
+                        accumulate(data + begin, end - begin, level_exp, parts[t]);
+                    }));
                 }
-                if(index > 0){
-                    for(int b=exp_diff; b<prec; b++){
-                        // change b-th bit to 0
-                        fi.i &= ~(1u << b);
-                        squared_error[index] += (data[i] - fi.f)*(data[i] - fi.f);
-                        index --;
-                    }
-                    while(index >= 0){
-                        squared_error[index] += data[i] * data[i];
-                        index --;
-                    }
+                for(auto& task:tasks) task.get();
+            }
+            for(int t=1; t<num_parts; t++) parts[0].merge(parts[t]);
+            const Buckets& buckets = parts[0];
+
+            // bucket d holds the values with exponent level_exp - d, d in [-prec, encode_prec)
+            // with k bitplanes, the c = d + prec + 1 - k trailing bits of the mantissa are lost
+            for(int d=-prec; d<encode_prec; d++){
+                const double * sums = buckets.bucket(d);
+                const int scale_exp = 2 * (level_exp - d - 1 - prec);
+                for(int k=0; k<=encode_prec; k++){
+                    int c = d + prec + 1 - k;
+                    if(c <= 0) break;
+                    squared_error[k] += ldexp(sums[std::min(c, prec + 1)], scale_exp);
                 }
             }
+            // values below the last bitplane are lost entirely
+            for(int k=0; k<=encode_prec; k++){
+                squared_error[k] += buckets.below;
+            }
             return squared_error;
         }
+        bool approximate() const {
+            return false;
+        }
         void print() const {
             std::cout << "Squared error collector." << std::endl;
         }
+    private:
+        static const int prec = std::is_same<T, double>::value ? 52 : 23;
+        static const size_t min_elements_per_thread = 1 << 16;
+        using FloatingInt = typename std::conditional<std::is_same<T, double>::value, FloatingInt64, FloatingInt32>::type;
+        using UInt = typename std::conditional<std::is_same<T, double>::value, uint64_t, uint32_t>::type;
+
+        // sum of (M mod 2^c)^2 for c in [0, prec + 1] per relative exponent, plus the squares of the values below all bitplanes
+        struct Buckets{
+            Buckets(int encode_prec) : encode_prec(encode_prec), sums((encode_prec + prec) * (prec + 2), 0) {}
+
+            double * bucket(int d){
+                return sums.data() + (d + prec) * (prec + 2);
+            }
+            const double * bucket(int d) const {
+                return sums.data() + (d + prec) * (prec + 2);
+            }
+            void merge(const Buckets& other){
+                for(size_t i=0; i<sums.size(); i++) sums[i] += other.sums[i];
+                below += other.below;
+            }
+
+            int encode_prec;
+            std::vector<double> sums;
+            double below = 0;
+        };
+
+        void accumulate(T const * data, size_t n, int level_exp, Buckets& buckets) const {
+            const UInt mantissa_mask = (((UInt) 1) << prec) - 1;
+            const UInt exponent_mask = (sizeof(T) == 8) ? 0x7ff : 0xff;
+            const int exponent_bias = (sizeof(T) == 8) ? 1022 : 126;
+            UInt masks[prec + 2];
+            for(int c=0; c<=prec; c++) masks[c] = (((UInt) 1) << c) - 1;
+            masks[prec + 1] = ~((UInt) 0);
+            FloatingInt fi;
+            for(size_t i=0; i<n; i++){
+                fi.f = data[i];
+                UInt biased_exp = (fi.i >> prec) & exponent_mask;
+                UInt mantissa = 0;
+                int data_exp = 0;
+                if(biased_exp == 0){
+                    // zero and subnormal values
+                    if(data[i] == 0) continue;
+                    T m = frexp(fabs(data[i]), &data_exp);
+                    mantissa = (UInt) ldexp(m, prec + 1);
+                }
+                else if(biased_exp == exponent_mask) continue;
+                else{
+                    // frexp exponent: value = 0.M * 2^data_exp
+                    data_exp = (int) biased_exp - exponent_bias;
+                    mantissa = (fi.i & mantissa_mask) | (mantissa_mask + 1);
+                }
+                int d = level_exp - data_exp;
+                if(d >= buckets.encode_prec){
+                    buckets.below += (double) data[i] * data[i];
+                    continue;
+                }
+                // values exceeding the level bound by more than the mantissa length are always exact
+                if(d < -prec) continue;
+                double * sums = buckets.bucket(d);
+                for(int c=1; c<=prec+1; c++){
+                    double r = (double) (mantissa & masks[c]);
+                    sums[c] += r * r;
+                }
+            }
+        }
+
+        int num_threads;
     };
 }
 #endif
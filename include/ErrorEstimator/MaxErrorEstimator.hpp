@@ -3,8 +3,6 @@
 
 #include "ErrorEstimatorInterface.hpp"
 
-double c = 0;
-
 namespace MDR {
     template<class T>
     class MaxErrorEstimator : public concepts::ErrorEstimatorInterface<T>{
@@ -15,43 +13,47 @@ namespace MDR {
     class MaxErrorEstimatorOB : public MaxErrorEstimator<T> {
     public:
         MaxErrorEstimatorOB(int num_dims){
-            //switch(num_dims){
-            //    case 1:
-            //        c = 1.0 + sqrt(3)/2;
-            //        break;
-            //    case 2:
-            //        c = 1.0 + 9.0/4;
-            //        break;
-            //    case 3:
-            //        c = 1.0 + 21.0*sqrt(3)/8;
-            //        break;
-            //    default:
-            //        std::cerr << num_dims << "-Dimentional error estimation not implemented." << std::endl;
-            //        exit(-1);
-            //}
-    	    //c = 1.0 + 21.0*sqrt(3)/8;
-    	    //c *= 4; // 2 more bitplane for negabinary
+            switch(num_dims){
+                case 1:
+                    default_c = 1.0 + sqrt(3)/2;
+                    break;
+                case 2:
+                    default_c = 1.0 + 9.0/4;
+                    break;
+                case 3:
+                    default_c = 1.0 + 21.0*sqrt(3)/8;
+                    break;
+                default:
+                    // no derived constant: fall back to the 3-dimensional one, pass level_c to tune it
+                    std::cerr << num_dims << "-Dimentional error estimation not implemented, using the 3-dimensional constant." << std::endl;
+                    default_c = 1.0 + 21.0*sqrt(3)/8;
+            }
+        }
+        // per-level constants, e.g. tuned empirically; levels beyond the table use the last constant
+        MaxErrorEstimatorOB(const std::vector<T>& level_c) : level_c(level_c) {
+            if(level_c.size()) default_c = level_c.back();
         }
         MaxErrorEstimatorOB() : MaxErrorEstimatorOB(1) {}
 
         inline T estimate_error(T error, int level) const {
-            // std::cout << "c=" << c << std::endl;
-            return c * error;
+            return get_c(level) * error;
         }
         inline T estimate_error(T data, T reconstructed_data, int level) const {
-            //std::cout << "c=" << c << std::endl;
-            return c * (data - reconstructed_data);
+            return get_c(level) * (data - reconstructed_data);
         }
         inline T estimate_error_gain(T base, T current_level_err, T next_level_err, int level) const {
-            //std::cout << "c=" << c << std::endl;
-            return c * (current_level_err - next_level_err);
+            return get_c(level) * (current_level_err - next_level_err);
         }
         void print() const {
             std::cout << "Max absolute error estimator (up to 3 dimensions) for orthogonal basis." << std::endl;
         }
     private:
-        // derived constant
-        //T c = 0;
+        inline T get_c(int level) const {
+            return (level < level_c.size()) ? level_c[level] : default_c;
+        }
+        // derived constants
+        std::vector<T> level_c;
+        T default_c = 0;
     };
     // max error estimator for hierarchical basis
     // c = 1 as all the operations are linear
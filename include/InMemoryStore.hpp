@@ -0,0 +1,25 @@
+#ifndef _MDR_IN_MEMORY_STORE_HPP
+#define _MDR_IN_MEMORY_STORE_HPP
+
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+namespace MDR {
+    // Refactored data kept in memory, shared by an InMemoryWriter and the InMemoryRetrievers reading from it
+    // each level is stored as its concatenated bitplanes; pointers handed out by a retriever stay valid until the next refactor
+    struct InMemoryStore{
+        std::vector<std::vector<uint8_t>> levels;
+        std::vector<uint8_t> metadata;
+        std::mutex mutex;
+
+        uint64_t size() const {
+            uint64_t total_size = metadata.size();
+            for(const auto& level:levels){
+                total_size += level.size();
+            }
+            return total_size;
+        }
+    };
+}
+#endif
@@ -16,7 +16,7 @@ namespace MDR {
             size_t n1_coeff = dims_fine[0] - n1_nodal;
             size_t n2_coeff = dims_fine[1] - n2_nodal;
             size_t n3_coeff = dims_fine[2] - n3_nodal;
-            size_t dim0_offset = dims[1] * dims[2];
+            size_t dim0_offset = (size_t) dims[1] * dims[2];
             size_t dim1_offset = dims[2];
             const int block_size = 4;
             if(n1_nodal * n2_nodal * n3_nodal == 0){
@@ -47,7 +47,7 @@ namespace MDR {
             size_t n1_coeff = dims_fine[0] - n1_nodal;
             size_t n2_coeff = dims_fine[1] - n2_nodal;
             size_t n3_coeff = dims_fine[2] - n3_nodal;
-            size_t dim0_offset = dims[1] * dims[2];
+            size_t dim0_offset = (size_t) dims[1] * dims[2];
             size_t dim1_offset = dims[2];
             const int block_size = 4;
             if(n1_nodal * n2_nodal * n3_nodal == 0){
@@ -81,18 +81,18 @@ namespace MDR {
             size_t num_block_3 = (n3 - 1) / block_size + 1;
             size_t index = 0;
             const T * data_x_pos = data;
-            for(int i=0; i<num_block_1; i++){
-                int size_1 = (i == num_block_1 - 1) ? n1 - i * block_size : block_size;
+            for(size_t i=0; i<num_block_1; i++){
+                size_t size_1 = (i == num_block_1 - 1) ? n1 - i * block_size : block_size;
                 const T * data_y_pos = data_x_pos;
-                for(int j=0; j<num_block_2; j++){
-                    int size_2 = (j == num_block_2 - 1) ? n2 - j * block_size : block_size;
+                for(size_t j=0; j<num_block_2; j++){
+                    size_t size_2 = (j == num_block_2 - 1) ? n2 - j * block_size : block_size;
                     const T * data_z_pos = data_y_pos;
-                    for(int k=0; k<num_block_3; k++){
-                        int size_3 = (k == num_block_3 - 1) ? n3 - k * block_size : block_size;
+                    for(size_t k=0; k<num_block_3; k++){
+                        size_t size_3 = (k == num_block_3 - 1) ? n3 - k * block_size : block_size;
                         const T * cur_data_pos = data_z_pos;
-                        for(int ii=0; ii<size_1; ii++){
-                            for(int jj=0; jj<size_2; jj++){
-                                for(int kk=0; kk<size_3; kk++){
+                        for(size_t ii=0; ii<size_1; ii++){
+                            for(size_t jj=0; jj<size_2; jj++){
+                                for(size_t kk=0; kk<size_3; kk++){
                                     buffer[index ++] = *cur_data_pos;
                                     cur_data_pos ++;
                                 }
@@ -114,18 +114,18 @@ namespace MDR {
             size_t num_block_3 = (n3 - 1) / block_size + 1;
             size_t index = 0;
             T * data_x_pos = data;
-            for(int i=0; i<num_block_1; i++){
-                int size_1 = (i == num_block_1 - 1) ? n1 - i * block_size : block_size;
+            for(size_t i=0; i<num_block_1; i++){
+                size_t size_1 = (i == num_block_1 - 1) ? n1 - i * block_size : block_size;
                 T * data_y_pos = data_x_pos;
-                for(int j=0; j<num_block_2; j++){
-                    int size_2 = (j == num_block_2 - 1) ? n2 - j * block_size : block_size;
+                for(size_t j=0; j<num_block_2; j++){
+                    size_t size_2 = (j == num_block_2 - 1) ? n2 - j * block_size : block_size;
                     T * data_z_pos = data_y_pos;
-                    for(int k=0; k<num_block_3; k++){
-                        int size_3 = (k == num_block_3 - 1) ? n3 - k * block_size : block_size;
+                    for(size_t k=0; k<num_block_3; k++){
+                        size_t size_3 = (k == num_block_3 - 1) ? n3 - k * block_size : block_size;
                         T * cur_data_pos = data_z_pos;
-                        for(int ii=0; ii<size_1; ii++){
-                            for(int jj=0; jj<size_2; jj++){
-                                for(int kk=0; kk<size_3; kk++){
+                        for(size_t ii=0; ii<size_1; ii++){
+                            for(size_t jj=0; jj<size_2; jj++){
+                                for(size_t kk=0; kk<size_3; kk++){
                                     *cur_data_pos = buffer[index ++];
                                     cur_data_pos ++;
                                 }
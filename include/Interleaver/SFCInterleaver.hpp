@@ -2,6 +2,7 @@
 #define _MDR_SFC_INTERLEAVER_HPP
 
 #include "InterleaverInterface.hpp"
+#include "Allocator/Allocator.hpp"
 
 namespace MDR {
     // direct interleaver with in-order recording
@@ -16,7 +17,7 @@ namespace MDR {
             size_t n1_coeff = dims_fine[0] - n1_nodal;
             size_t n2_coeff = dims_fine[1] - n2_nodal;
             size_t n3_coeff = dims_fine[2] - n3_nodal;
-            size_t dim0_offset = dims[1] * dims[2];
+            size_t dim0_offset = (size_t) dims[1] * dims[2];
             size_t dim1_offset = dims[2];
             const int block_size = 1;
             if(n1_nodal * n2_nodal * n3_nodal == 0){
@@ -30,7 +31,7 @@ namespace MDR {
                 const T * coeff_nodal_coeff_pos = coeff_nodal_nodal_pos + n3_nodal;
                 const T * coeff_coeff_nodal_pos = coeff_nodal_nodal_pos + n2_nodal * dim1_offset;
                 const T * coeff_coeff_coeff_pos = coeff_coeff_nodal_pos + n3_nodal;
-                T * tmp_buffer = (T *) malloc(dims_fine[0] * dims_fine[1] * dims_fine[2] * sizeof(T));
+                T * tmp_buffer = (T *) allocate((size_t) dims_fine[0] * dims_fine[1] * dims_fine[2] * sizeof(T));
                 T * buffer_pos = tmp_buffer;
                 const T * pos[7];
                 pos[0] = buffer_pos;
@@ -49,7 +50,7 @@ namespace MDR {
                 buffer_pos += collect_data_3d_blocked(coeff_coeff_coeff_pos, n1_coeff, n2_coeff, n3_coeff, dim0_offset, dim1_offset, block_size, buffer_pos);
                 // z_order_data_collection(pos, buffer, n1_nodal, n1_coeff, n2_nodal, n2_coeff, n3_nodal, n3_coeff);
                 skip_one_data_collection(pos, buffer, n1_nodal, n1_coeff, n2_nodal, n2_coeff, n3_nodal, n3_coeff);
-                free(tmp_buffer);
+                deallocate(tmp_buffer);
             }
         }
         void reposition(T const * buffer, const std::vector<uint32_t>& dims, const std::vector<uint32_t>& dims_fine, const std::vector<uint32_t>& dims_coasre, T * data) const {
@@ -59,7 +60,7 @@ namespace MDR {
             size_t n1_coeff = dims_fine[0] - n1_nodal;
             size_t n2_coeff = dims_fine[1] - n2_nodal;
             size_t n3_coeff = dims_fine[2] - n3_nodal;
-            size_t dim0_offset = dims[1] * dims[2];
+            size_t dim0_offset = (size_t) dims[1] * dims[2];
             size_t dim1_offset = dims[2];
             const int block_size = 1;
             if(n1_nodal * n2_nodal * n3_nodal == 0){
@@ -73,7 +74,7 @@ namespace MDR {
                 T * coeff_nodal_coeff_pos = coeff_nodal_nodal_pos + n3_nodal;
                 T * coeff_coeff_nodal_pos = coeff_nodal_nodal_pos + n2_nodal * dim1_offset;
                 T * coeff_coeff_coeff_pos = coeff_coeff_nodal_pos + n3_nodal;
-                T * tmp_buffer = (T *) malloc(dims_fine[0] * dims_fine[1] * dims_fine[2] * sizeof(T));        
+                T * tmp_buffer = (T *) allocate((size_t) dims_fine[0] * dims_fine[1] * dims_fine[2] * sizeof(T));        
                 T * pos[7];
                 pos[0] = tmp_buffer;
                 pos[1] = pos[0] + n1_nodal * n2_nodal * n3_coeff;
@@ -92,7 +93,7 @@ namespace MDR {
                 reposition_data_3d_blocked(pos[3], n1_coeff, n2_nodal, n3_coeff, dim0_offset, dim1_offset, block_size, coeff_nodal_coeff_pos);
                 reposition_data_3d_blocked(pos[4], n1_coeff, n2_coeff, n3_nodal, dim0_offset, dim1_offset, block_size, coeff_coeff_nodal_pos);
                 reposition_data_3d_blocked(pos[5], n1_coeff, n2_coeff, n3_coeff, dim0_offset, dim1_offset, block_size, coeff_coeff_coeff_pos);
-                free(tmp_buffer);
+                deallocate(tmp_buffer);
             }
         }
         void print() const {
@@ -105,18 +106,18 @@ namespace MDR {
             size_t num_block_3 = (n3 - 1) / block_size + 1;
             size_t index = 0;
             const T * data_x_pos = data;
-            for(int i=0; i<num_block_1; i++){
-                int size_1 = (i == num_block_1 - 1) ? n1 - i * block_size : block_size;
+            for(size_t i=0; i<num_block_1; i++){
+                size_t size_1 = (i == num_block_1 - 1) ? n1 - i * block_size : block_size;
                 const T * data_y_pos = data_x_pos;
-                for(int j=0; j<num_block_2; j++){
-                    int size_2 = (j == num_block_2 - 1) ? n2 - j * block_size : block_size;
+                for(size_t j=0; j<num_block_2; j++){
+                    size_t size_2 = (j == num_block_2 - 1) ? n2 - j * block_size : block_size;
                     const T * data_z_pos = data_y_pos;
-                    for(int k=0; k<num_block_3; k++){
-                        int size_3 = (k == num_block_3 - 1) ? n3 - k * block_size : block_size;
+                    for(size_t k=0; k<num_block_3; k++){
+                        size_t size_3 = (k == num_block_3 - 1) ? n3 - k * block_size : block_size;
                         const T * cur_data_pos = data_z_pos;
-                        for(int ii=0; ii<size_1; ii++){
-                            for(int jj=0; jj<size_2; jj++){
-                                for(int kk=0; kk<size_3; kk++){
+                        for(size_t ii=0; ii<size_1; ii++){
+                            for(size_t jj=0; jj<size_2; jj++){
+                                for(size_t kk=0; kk<size_3; kk++){
                                     buffer[index ++] = *cur_data_pos;
                                     cur_data_pos ++;
                                 }
@@ -138,18 +139,18 @@ namespace MDR {
             size_t num_block_3 = (n3 - 1) / block_size + 1;
             size_t index = 0;
             T * data_x_pos = data;
-            for(int i=0; i<num_block_1; i++){
-                int size_1 = (i == num_block_1 - 1) ? n1 - i * block_size : block_size;
+            for(size_t i=0; i<num_block_1; i++){
+                size_t size_1 = (i == num_block_1 - 1) ? n1 - i * block_size : block_size;
                 T * data_y_pos = data_x_pos;
-                for(int j=0; j<num_block_2; j++){
-                    int size_2 = (j == num_block_2 - 1) ? n2 - j * block_size : block_size;
+                for(size_t j=0; j<num_block_2; j++){
+                    size_t size_2 = (j == num_block_2 - 1) ? n2 - j * block_size : block_size;
                     T * data_z_pos = data_y_pos;
-                    for(int k=0; k<num_block_3; k++){
-                        int size_3 = (k == num_block_3 - 1) ? n3 - k * block_size : block_size;
+                    for(size_t k=0; k<num_block_3; k++){
+                        size_t size_3 = (k == num_block_3 - 1) ? n3 - k * block_size : block_size;
                         T * cur_data_pos = data_z_pos;
-                        for(int ii=0; ii<size_1; ii++){
-                            for(int jj=0; jj<size_2; jj++){
-                                for(int kk=0; kk<size_3; kk++){
+                        for(size_t ii=0; ii<size_1; ii++){
+                            for(size_t jj=0; jj<size_2; jj++){
+                                for(size_t kk=0; kk<size_3; kk++){
                                     *cur_data_pos = buffer[index ++];
                                     cur_data_pos ++;
                                 }
@@ -173,10 +174,10 @@ namespace MDR {
             3d 0-7 => 2-1-3-6-4-5-7
         */
         void skip_one_data_collection(const T * pos[7], T * buffer, size_t n1_nodal, size_t n1_coeff, size_t n2_nodal, size_t n2_coeff, size_t n3_nodal, size_t n3_coeff) const{
-            int index = 0;
-            for(int i=0; i<n1_coeff; i++){
-                for(int j=0; j<n2_coeff; j++){
-                    for(int k=0; k<n3_coeff; k++){
+            size_t index = 0;
+            for(size_t i=0; i<n1_coeff; i++){
+                for(size_t j=0; j<n2_coeff; j++){
+                    for(size_t k=0; k<n3_coeff; k++){
                         buffer[index ++] = *pos[1];
                         pos[1] ++;
                         buffer[index ++] = *pos[0];
@@ -192,7 +193,7 @@ namespace MDR {
                         buffer[index ++] = *pos[6];
                         pos[6] ++;
                     }
-                    for(int k=n3_coeff; k<n3_nodal; k++){
+                    for(size_t k=n3_coeff; k<n3_nodal; k++){
                         buffer[index ++] = *pos[1];
                         pos[1] ++;
                         buffer[index ++] = *pos[5];
@@ -201,8 +202,8 @@ namespace MDR {
                         pos[3] ++;
                     }
                 }
-                for(int j=n2_coeff; j<n2_nodal; j++){
-                    for(int k=0; k<n3_coeff; k++){
+                for(size_t j=n2_coeff; j<n2_nodal; j++){
+                    for(size_t k=0; k<n3_coeff; k++){
                         buffer[index ++] = *pos[0];
                         pos[0] ++;
                         buffer[index ++] = *pos[3];
@@ -210,15 +211,15 @@ namespace MDR {
                         buffer[index ++] = *pos[4];
                         pos[4] ++;
                     }
-                    for(int k=n3_coeff; k<n3_nodal; k++){
+                    for(size_t k=n3_coeff; k<n3_nodal; k++){
                         buffer[index ++] = *pos[3];
                         pos[3] ++;
                     }
                 }
             }
-            for(int i=n1_coeff; i<n1_nodal; i++){
-                for(int j=0; j<n2_coeff; j++){
-                    for(int k=0; k<n3_coeff; k++){
+            for(size_t i=n1_coeff; i<n1_nodal; i++){
+                for(size_t j=0; j<n2_coeff; j++){
+                    for(size_t k=0; k<n3_coeff; k++){
                         buffer[index ++] = *pos[1];
                         pos[1] ++;
                         buffer[index ++] = *pos[0];
@@ -226,13 +227,13 @@ namespace MDR {
                         buffer[index ++] = *pos[2];
                         pos[2] ++;            
                     }
-                    for(int k=n3_coeff; k<n3_nodal; k++){
+                    for(size_t k=n3_coeff; k<n3_nodal; k++){
                         buffer[index ++] = *pos[1];
                         pos[1] ++;
                     }
                 }
-                for(int j=n2_coeff; j<n2_nodal; j++){
-                    for(int k=0; k<n3_coeff; k++){
+                for(size_t j=n2_coeff; j<n2_nodal; j++){
+                    for(size_t k=0; k<n3_coeff; k++){
                         buffer[index ++] = *pos[0];
                         pos[0] ++;
                     }                
@@ -240,10 +241,10 @@ namespace MDR {
             }    
         }        
         void skip_one_data_reposition(const T * buffer, T * pos[7], size_t n1_nodal, size_t n1_coeff, size_t n2_nodal, size_t n2_coeff, size_t n3_nodal, size_t n3_coeff) const{
-            int index = 0;
-            for(int i=0; i<n1_coeff; i++){
-                for(int j=0; j<n2_coeff; j++){
-                    for(int k=0; k<n3_coeff; k++){
+            size_t index = 0;
+            for(size_t i=0; i<n1_coeff; i++){
+                for(size_t j=0; j<n2_coeff; j++){
+                    for(size_t k=0; k<n3_coeff; k++){
                         *pos[1] = buffer[index ++];
                         pos[1] ++;
                         *pos[0] = buffer[index ++];
@@ -259,7 +260,7 @@ namespace MDR {
                         *pos[6] = buffer[index ++];
                         pos[6] ++;
                     }
-                    for(int k=n3_coeff; k<n3_nodal; k++){
+                    for(size_t k=n3_coeff; k<n3_nodal; k++){
                         *pos[1] = buffer[index ++];
                         pos[1] ++;
                         *pos[5] = buffer[index ++];
@@ -268,8 +269,8 @@ namespace MDR {
                         pos[3] ++;
                     }
                 }
-                for(int j=n2_coeff; j<n2_nodal; j++){
-                    for(int k=0; k<n3_coeff; k++){
+                for(size_t j=n2_coeff; j<n2_nodal; j++){
+                    for(size_t k=0; k<n3_coeff; k++){
                         *pos[0] = buffer[index ++];
                         pos[0] ++;
                         *pos[3] = buffer[index ++];
@@ -277,15 +278,15 @@ namespace MDR {
                         *pos[4] = buffer[index ++];
                         pos[4] ++;
                     }
-                    for(int k=n3_coeff; k<n3_nodal; k++){
+                    for(size_t k=n3_coeff; k<n3_nodal; k++){
                         *pos[3] = buffer[index ++];
                         pos[3] ++;
                     }
                 }
             }
-            for(int i=n1_coeff; i<n1_nodal; i++){
-                for(int j=0; j<n2_coeff; j++){
-                    for(int k=0; k<n3_coeff; k++){
+            for(size_t i=n1_coeff; i<n1_nodal; i++){
+                for(size_t j=0; j<n2_coeff; j++){
+                    for(size_t k=0; k<n3_coeff; k++){
                         *pos[1] = buffer[index ++];
                         pos[1] ++;
                         *pos[0] = buffer[index ++];
@@ -293,13 +294,13 @@ namespace MDR {
                         *pos[2] = buffer[index ++];
                         pos[2] ++;            
                     }
-                    for(int k=n3_coeff; k<n3_nodal; k++){
+                    for(size_t k=n3_coeff; k<n3_nodal; k++){
                         *pos[1] = buffer[index ++];
                         pos[1] ++;
                     }
                 }
-                for(int j=n2_coeff; j<n2_nodal; j++){
-                    for(int k=0; k<n3_coeff; k++){
+                for(size_t j=n2_coeff; j<n2_nodal; j++){
+                    for(size_t k=0; k<n3_coeff; k++){
                         *pos[0] = buffer[index ++];
                         pos[0] ++;
                     }                
@@ -3,53 +3,66 @@
 
 #include "LevelCompressorInterface.hpp"
 #include "LosslessCompressor.hpp"
+#include "Allocator/Allocator.hpp"
+#include <cmath>
+#include <algorithm>
 
 namespace MDR {
     #define CR_THRESHOLD 1.05
-    // compress all layers
+    // sampled byte entropy (bits per byte) above which a stream is treated as incompressible
+    #define ENTROPY_THRESHOLD 7.9
+    // compress layers that are predicted to be compressible
     class AdaptiveLevelCompressor : public concepts::LevelCompressorInterface {
     public:
-        AdaptiveLevelCompressor(int l = 26) : latter_index(l) {}
-        uint8_t compress_level(std::vector<uint8_t*>& streams, std::vector<uint32_t>& stream_sizes) const {
-            int stopping_index = stream_sizes.size();
+        // latter_index: first bitplane that the legacy format compressed regardless of the stopping index
+        // at least one sample of at least one byte is taken
+        AdaptiveLevelCompressor(int latter_index = 26, uint32_t sample_size = 4096, uint32_t num_samples = 8) : latter_index(latter_index), sample_size(std::max(sample_size, 1u)), num_samples(std::max(std::min(num_samples, sample_size), 1u)) {}
+        std::vector<uint8_t> compress_level(std::vector<uint8_t*>& streams, std::vector<uint64_t>& stream_sizes) const {
+            std::vector<uint8_t> compressed_flags(streams.size(), 0);
+            std::vector<uint8_t> sample(sample_size);
             for(int i=0; i<streams.size(); i++){
+                if(!predict_compressible(streams[i], stream_sizes[i], sample)) continue;
                 uint8_t * compressed = NULL;
                 auto compressed_size = ZSTD::compress(streams[i], stream_sizes[i], &compressed);
-                free(streams[i]);
                 // std::cout << compressed_size << " " << stream_sizes[i] << " " << stream_sizes[i] * 1.0 / compressed_size << std::endl;
-                // skip the first
-                float ratio = stream_sizes[i] * 1.0 / compressed_size;
-                streams[i] = compressed;
-                stream_sizes[i] = compressed_size;
-                if(i && (ratio < CR_THRESHOLD)){
-                    stopping_index = i;
-                    break;
+                // misprediction: keep the raw stream
+                if(stream_sizes[i] * 1.0 / compressed_size < CR_THRESHOLD){
+                    deallocate(compressed);
+                    continue;
                 }
-            }
-            int latter_start_index = (stopping_index < latter_index) ? latter_index : stopping_index + 1;
-            for(int i=latter_start_index; i<streams.size(); i++){
-                uint8_t * compressed = NULL;
-                auto compressed_size = ZSTD::compress(streams[i], stream_sizes[i], &compressed);
-                free(streams[i]);
+                deallocate(streams[i]);
                 streams[i] = compressed;
                 stream_sizes[i] = compressed_size;
+                compressed_flags[i] = 1;
             }
-            return stopping_index;
+            return compressed_flags;
         }
-        void decompress_level(std::vector<const uint8_t*>& streams, const std::vector<uint32_t>& stream_sizes, uint8_t starting_bitplane, uint8_t num_bitplanes, uint8_t stopping_index) {
+        void decompress_level(std::vector<const uint8_t*>& streams, const std::vector<uint64_t>& stream_sizes, uint8_t starting_bitplane, uint8_t num_bitplanes, const std::vector<uint8_t>& compressed_flags) {
             for(int i=0; i<num_bitplanes; i++){
                 int bitplane_index = starting_bitplane + i;
-                if((bitplane_index <= stopping_index) || (bitplane_index >= latter_index)){
+                if(compressed_flags[bitplane_index]){
                     uint8_t * decompressed = NULL;
                     auto decompressed_size = ZSTD::decompress(streams[i], stream_sizes[bitplane_index], &decompressed);
                     buffer.push_back(decompressed);
-                    streams[i] = decompressed;                    
+                    streams[i] = decompressed;
                 }
             }
         }
+        // streams up to the stopping index and streams from the latter index on were compressed
+        std::vector<uint8_t> legacy_compressed_flags(uint8_t stopping_index, int num_streams) const {
+            std::vector<uint8_t> compressed_flags(num_streams, 0);
+            for(int i=0; (i<=stopping_index) && (i<num_streams); i++){
+                compressed_flags[i] = 1;
+            }
+            int latter_start_index = (stopping_index < latter_index) ? latter_index : stopping_index + 1;
+            for(int i=latter_start_index; i<num_streams; i++){
+                compressed_flags[i] = 1;
+            }
+            return compressed_flags;
+        }
         void decompress_release(){
             for(int i=0; i<buffer.size(); i++){
-                if(buffer[i]) free(buffer[i]);
+                if(buffer[i]) deallocate(buffer[i]);
             }
             buffer.clear();
         }
@@ -60,7 +73,38 @@ namespace MDR {
             decompress_release();
         }
     private:
+        // predict compressibility from evenly spaced chunks of the stream:
+        // a near-uniform byte histogram means incompressible, otherwise trial-compress the sample
+        bool predict_compressible(uint8_t const * stream, uint64_t size, std::vector<uint8_t>& sample) const {
+            // small streams are cheap to compress directly
+            if(size <= 2 * sample_size) return true;
+            const uint32_t chunk_size = sample_size / num_samples;
+            const uint64_t stride = size / num_samples;
+            uint8_t * sample_pos = sample.data();
+            for(int i=0; i<num_samples; i++){
+                memcpy(sample_pos, stream + i * stride, chunk_size);
+                sample_pos += chunk_size;
+            }
+            const uint32_t sampled_size = sample_pos - sample.data();
+            uint32_t histogram[256] = {0};
+            for(int i=0; i<sampled_size; i++){
+                histogram[sample[i]] ++;
+            }
+            double entropy = 0;
+            for(int i=0; i<256; i++){
+                if(histogram[i] == 0) continue;
+                double p = histogram[i] * 1.0 / sampled_size;
+                entropy -= p * log2(p);
+            }
+            if(entropy > ENTROPY_THRESHOLD) return false;
+            uint8_t * compressed = NULL;
+            auto compressed_size = ZSTD::compress(sample.data(), sampled_size, &compressed);
+            deallocate(compressed);
+            return sampled_size * 1.0 / (compressed_size - sizeof(size_t)) >= CR_THRESHOLD;
+        }
         int latter_index;
+        uint32_t sample_size;
+        uint32_t num_samples;
         std::vector<uint8_t*> buffer;
     };
 }
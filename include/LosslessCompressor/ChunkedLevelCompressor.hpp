@@ -0,0 +1,194 @@
+#ifndef _MDR_CHUNKED_LEVEL_COMPRESSOR_HPP
+#define _MDR_CHUNKED_LEVEL_COMPRESSOR_HPP
+
+#include "LevelCompressorInterface.hpp"
+#include "LosslessCompressor.hpp"
+#include "RefactorUtils.hpp"
+#include "ThreadPool.hpp"
+#include "Allocator/Allocator.hpp"
+#include <memory>
+#include <future>
+#include <cstring>
+#include <cstdint>
+
+namespace MDR {
+    // Per-chunk index at the head of a chunked bitplane stream
+    // stream: [raw size (uint64_t)][chunk size (uint32_t)][number of chunks (uint32_t)]
+    //         [payload offset of each chunk and the payload end (uint64_t)][flag of each chunk (uint8_t, 1: ZSTD, 0: raw)][payloads]
+    struct ChunkIndex{
+        uint64_t raw_size = 0;
+        uint32_t chunk_size = 0;
+        std::vector<uint64_t> offsets;
+        std::vector<uint8_t> flags;
+
+        uint32_t num_chunks() const {
+            return flags.size();
+        }
+        static uint64_t header_size(uint32_t num_chunks){
+            return sizeof(uint64_t) + 2 * sizeof(uint32_t) + (num_chunks + 1) * sizeof(uint64_t) + num_chunks * sizeof(uint8_t);
+        }
+        uint64_t header_size() const {
+            return header_size(num_chunks());
+        }
+        // raw bytes of chunk k
+        uint64_t raw_chunk_size(uint32_t k) const {
+            return std::min<uint64_t>(chunk_size, raw_size - (uint64_t) k * chunk_size);
+        }
+        // chunks [first, last) overlapping the raw byte range [begin, end)
+        std::pair<uint32_t, uint32_t> overlapping(uint64_t begin, uint64_t end) const {
+            end = std::min(end, raw_size);
+            if(begin >= end) return std::make_pair(0u, 0u);
+            return std::make_pair((uint32_t) (begin / chunk_size), (uint32_t) ((end - 1) / chunk_size + 1));
+        }
+        // stream bytes to fetch for the raw byte range [begin, end): the header followed by the overlapping payloads
+        std::pair<uint64_t, uint64_t> stream_range(uint64_t begin, uint64_t end) const {
+            auto chunks = overlapping(begin, end);
+            return std::make_pair(header_size() + offsets[chunks.first], header_size() + offsets[chunks.second]);
+        }
+        void serialize(uint8_t *& buffer_pos) const {
+            *reinterpret_cast<uint64_t*>(buffer_pos) = raw_size;
+            buffer_pos += sizeof(uint64_t);
+            *reinterpret_cast<uint32_t*>(buffer_pos) = chunk_size;
+            buffer_pos += sizeof(uint32_t);
+            *reinterpret_cast<uint32_t*>(buffer_pos) = num_chunks();
+            buffer_pos += sizeof(uint32_t);
+            MDR::serialize(offsets, buffer_pos);
+            MDR::serialize(flags, buffer_pos);
+        }
+        void deserialize(uint8_t const *& buffer_pos){
+            raw_size = *reinterpret_cast<const uint64_t*>(buffer_pos);
+            buffer_pos += sizeof(uint64_t);
+            chunk_size = *reinterpret_cast<const uint32_t*>(buffer_pos);
+            buffer_pos += sizeof(uint32_t);
+            uint32_t n = *reinterpret_cast<const uint32_t*>(buffer_pos);
+            buffer_pos += sizeof(uint32_t);
+            MDR::deserialize(buffer_pos, n + 1, offsets);
+            MDR::deserialize(buffer_pos, n, flags);
+        }
+    };
+
+    // compress every bitplane as independent fixed-size chunks with a per-chunk offset index
+    // with one bit per element and bitplane (NegaBinaryBPEncoder), a chunk holds the bits of chunk_elements consecutive elements;
+    // other encoders pack bitplanes with variable length, so their chunks are plain byte ranges
+    // chunks are compressed and decompressed concurrently, and decompress_range only decompresses the chunks
+    // overlapping a byte range, so a region of interest does not pay for the whole bitplane
+    class ChunkedLevelCompressor : public concepts::LevelCompressorInterface {
+    public:
+        ChunkedLevelCompressor(uint64_t chunk_elements = 1 << 20, int num_threads = std::thread::hardware_concurrency())
+            : chunk_size(std::min<uint64_t>(std::max<uint64_t>(chunk_elements / 8, 1), UINT32_MAX)), pool(std::make_shared<ThreadPool>(std::max(1, num_threads))) {}
+
+        std::vector<uint8_t> compress_level(std::vector<uint8_t*>& streams, std::vector<uint64_t>& stream_sizes) const {
+            // compress the chunks of all bitplanes of the level at once
+            std::vector<std::vector<uint8_t*>> compressed(streams.size());
+            std::vector<std::vector<uint64_t>> compressed_sizes(streams.size());
+            std::vector<std::future<void>> tasks;
+            for(int i=0; i<streams.size(); i++){
+                const uint32_t num_chunks = (stream_sizes[i] + chunk_size - 1) / chunk_size;
+                compressed[i] = std::vector<uint8_t*>(num_chunks, NULL);
+                compressed_sizes[i] = std::vector<uint64_t>(num_chunks, 0);
+                for(uint32_t k=0; k<num_chunks; k++){
+                    uint8_t const * chunk = streams[i] + (uint64_t) k * chunk_size;
+                    uint64_t size = std::min<uint64_t>(chunk_size, stream_sizes[i] - (uint64_t) k * chunk_size);
+                    uint8_t ** dst = &compressed[i][k];
+                    uint64_t * dst_size = &compressed_sizes[i][k];
+                    tasks.push_back(pool->submit([chunk, size, dst, dst_size](){
+                        *dst_size = ZSTD::compress(chunk, size, dst);
+                        // incompressible chunk: keep it raw
+                        if(*dst_size >= size){
+                            deallocate(*dst);
+                            *dst = NULL;
+                        }
+                    }));
+                }
+            }
+            for(auto& t:tasks) t.get();
+            for(int i=0; i<streams.size(); i++){
+                ChunkIndex index;
+                index.raw_size = stream_sizes[i];
+                index.chunk_size = chunk_size;
+                index.offsets.push_back(0);
+                for(uint32_t k=0; k<compressed[i].size(); k++){
+                    index.flags.push_back(compressed[i][k] != NULL);
+                    index.offsets.push_back(index.offsets.back() + (compressed[i][k] ? compressed_sizes[i][k] : index.raw_chunk_size(k)));
+                }
+                uint64_t size = index.header_size() + index.offsets.back();
+                uint8_t * chunked = (uint8_t *) allocate(size);
+                uint8_t * chunked_pos = chunked;
+                index.serialize(chunked_pos);
+                for(uint32_t k=0; k<compressed[i].size(); k++){
+                    if(compressed[i][k]){
+                        memcpy(chunked_pos, compressed[i][k], compressed_sizes[i][k]);
+                        deallocate(compressed[i][k]);
+                    }
+                    else{
+                        memcpy(chunked_pos, streams[i] + (uint64_t) k * chunk_size, index.raw_chunk_size(k));
+                    }
+                    chunked_pos += index.offsets[k + 1] - index.offsets[k];
+                }
+                deallocate(streams[i]);
+                streams[i] = chunked;
+                stream_sizes[i] = size;
+            }
+            return std::vector<uint8_t>(streams.size(), 1);
+        }
+        void decompress_level(std::vector<const uint8_t*>& streams, const std::vector<uint64_t>& stream_sizes, uint8_t starting_bitplane, uint8_t num_bitplanes, const std::vector<uint8_t>& compressed_flags) {
+            std::vector<std::future<void>> tasks;
+            for(int i=0; i<num_bitplanes; i++){
+                if(!compressed_flags[starting_bitplane + i]) continue;
+                ChunkIndex index;
+                uint8_t const * payload = streams[i];
+                index.deserialize(payload);
+                uint8_t * decompressed = (uint8_t *) allocate(index.raw_size > 0 ? index.raw_size : 1);
+                submit_chunks(index, payload, 0, index.num_chunks(), decompressed, tasks);
+                buffer.push_back(decompressed);
+                streams[i] = decompressed;
+            }
+            for(auto& t:tasks) t.get();
+        }
+        // decompress the chunks of a chunked stream overlapping the raw byte range [begin, end) into data,
+        // which has the raw size of the stream; bytes of the other chunks are left untouched
+        // the stream only needs the bytes given by ChunkIndex::stream_range
+        void decompress_range(uint8_t const * stream, uint64_t begin, uint64_t end, uint8_t * data) const {
+            ChunkIndex index;
+            uint8_t const * payload = stream;
+            index.deserialize(payload);
+            auto chunks = index.overlapping(begin, end);
+            std::vector<std::future<void>> tasks;
+            submit_chunks(index, payload, chunks.first, chunks.second, data, tasks);
+            for(auto& t:tasks) t.get();
+        }
+        std::vector<uint8_t> legacy_compressed_flags(uint8_t stopping_index, int num_streams) const {
+            return std::vector<uint8_t>(num_streams, 1);
+        }
+        void decompress_release(){
+            for(int i=0; i<buffer.size(); i++){
+                deallocate(buffer[i]);
+            }
+            buffer.clear();
+        }
+        void print() const {
+            std::cout << "Chunked level lossless compressor with " << chunk_size << "-byte chunks" << std::endl;
+        }
+        ~ChunkedLevelCompressor(){
+            decompress_release();
+        }
+    private:
+        void submit_chunks(const ChunkIndex& index, uint8_t const * payload, uint32_t first, uint32_t last, uint8_t * data, std::vector<std::future<void>>& tasks) const {
+            for(uint32_t k=first; k<last; k++){
+                uint8_t const * src = payload + index.offsets[k];
+                uint64_t size = index.offsets[k + 1] - index.offsets[k];
+                uint8_t * dst = data + (uint64_t) k * index.chunk_size;
+                bool compressed = index.flags[k];
+                tasks.push_back(pool->submit([src, size, dst, compressed](){
+                    if(compressed) ZSTD::decompress_to(src, size, dst);
+                    else memcpy(dst, src, size);
+                }));
+            }
+        }
+
+        uint64_t chunk_size;
+        std::shared_ptr<ThreadPool> pool;
+        std::vector<uint8_t*> buffer;
+    };
+}
+#endif
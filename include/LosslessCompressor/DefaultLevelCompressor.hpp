@@ -4,27 +4,24 @@
 #include "LevelCompressorInterface.hpp"
 #include "LosslessCompressor.hpp"
 #include "RefactorUtils.hpp"
+#include "Allocator/Allocator.hpp"
 
 namespace MDR {
     // compress all layers
     class DefaultLevelCompressor : public concepts::LevelCompressorInterface {
     public:
         DefaultLevelCompressor(){}
-        uint8_t compress_level(std::vector<uint8_t*>& streams, std::vector<uint32_t>& stream_sizes) const {
-            Timer timer;
+        std::vector<uint8_t> compress_level(std::vector<uint8_t*>& streams, std::vector<uint64_t>& stream_sizes) const {
             for(int i=0; i<streams.size(); i++){
                 uint8_t * compressed = NULL;
-                timer.start();
                 auto compressed_size = ZSTD::compress(streams[i], stream_sizes[i], &compressed);
-                free(streams[i]);
-                timer.end();
+                deallocate(streams[i]);
                 streams[i] = compressed;
                 stream_sizes[i] = compressed_size;
             }
-            timer.print("Lossless: ");
-            return 0;
+            return std::vector<uint8_t>(streams.size(), 1);
         }
-        void decompress_level(std::vector<const uint8_t*>& streams, const std::vector<uint32_t>& stream_sizes, uint8_t starting_bitplane, uint8_t num_bitplanes, uint8_t stopping_index) {
+        void decompress_level(std::vector<const uint8_t*>& streams, const std::vector<uint64_t>& stream_sizes, uint8_t starting_bitplane, uint8_t num_bitplanes, const std::vector<uint8_t>& compressed_flags) {
             for(int i=0; i<num_bitplanes; i++){
                 uint8_t * decompressed = NULL;
                 auto decompressed_size = ZSTD::decompress(streams[i], stream_sizes[starting_bitplane + i], &decompressed);
@@ -32,9 +29,12 @@ namespace MDR {
                 streams[i] = decompressed;
             }
         }
+        std::vector<uint8_t> legacy_compressed_flags(uint8_t stopping_index, int num_streams) const {
+            return std::vector<uint8_t>(num_streams, 1);
+        }
         void decompress_release(){
             for(int i=0; i<buffer.size(); i++){
-                free(buffer[i]);
+                deallocate(buffer[i]);
             }
             buffer.clear();
         }
@@ -4,5 +4,6 @@
 #include "DefaultLevelCompressor.hpp"
 #include "AdaptiveLevelCompressor.hpp"
 #include "NullLevelCompressor.hpp"
+#include "ChunkedLevelCompressor.hpp"
 
 #endif
@@ -11,10 +11,14 @@ namespace MDR {
             virtual ~LevelCompressorInterface() = default;
 
             // compress level, overwrite and free original streams; rewrite streams sizes
-            virtual uint8_t compress_level(std::vector<uint8_t*>& streams, std::vector<uint32_t>& stream_sizes) const = 0;
+            // return per-stream flags (1: compressed, 0: stored raw)
+            virtual std::vector<uint8_t> compress_level(std::vector<uint8_t*>& streams, std::vector<uint64_t>& stream_sizes) const = 0;
 
             // decompress level, create new buffer and overwrite original streams; will not change stream sizes
-            virtual void decompress_level(std::vector<const uint8_t*>& streams, const std::vector<uint32_t>& stream_sizes, uint8_t starting_bitplane, uint8_t num_bitplanes, uint8_t stopping_index) = 0;
+            virtual void decompress_level(std::vector<const uint8_t*>& streams, const std::vector<uint64_t>& stream_sizes, uint8_t starting_bitplane, uint8_t num_bitplanes, const std::vector<uint8_t>& compressed_flags) = 0;
+
+            // translate the single stopping index recorded by version 1 metadata into per-stream flags
+            virtual std::vector<uint8_t> legacy_compressed_flags(uint8_t stopping_index, int num_streams) const = 0;
 
             // release the buffer created
             virtual void decompress_release() = 0;
@@ -8,8 +8,9 @@ namespace MDR {
     class NullLevelCompressor : public concepts::LevelCompressorInterface {
     public:
         NullLevelCompressor(){}
-        uint8_t compress_level(std::vector<uint8_t*>& streams, std::vector<uint32_t>& stream_sizes) const { return 0;}
-        void decompress_level(std::vector<const uint8_t*>& streams, const std::vector<uint32_t>& stream_sizes, uint8_t starting_bitplane, uint8_t num_bitplanes, uint8_t stopping_index){}
+        std::vector<uint8_t> compress_level(std::vector<uint8_t*>& streams, std::vector<uint64_t>& stream_sizes) const { return std::vector<uint8_t>(streams.size(), 0);}
+        void decompress_level(std::vector<const uint8_t*>& streams, const std::vector<uint64_t>& stream_sizes, uint8_t starting_bitplane, uint8_t num_bitplanes, const std::vector<uint8_t>& compressed_flags){}
+        std::vector<uint8_t> legacy_compressed_flags(uint8_t stopping_index, int num_streams) const { return std::vector<uint8_t>(num_streams, 0);}
         void decompress_release(){}
         void print() const {
             std::cout << "Null level compressor" << std::endl;
@@ -2,30 +2,41 @@
 #define _MDR_ZSTD_HPP
 
 #include "zstd.h"
+#include <iostream>
+#include <cstdlib>
+#include "Allocator/Allocator.hpp"
 
 namespace MDR {
     namespace ZSTD{
         #define ZSTD_LEVEL 3 //default setting of level is 3
         // ZSTD lossless compressor
-        uint32_t compress(const uint8_t* data, uint32_t dataLength, uint8_t** compressBytes) {
-            uint32_t outSize = 0; 
-            size_t estimatedCompressedSize = 0;
-            if(dataLength < 1024) 
-                estimatedCompressedSize = 2048;
-            else
-                estimatedCompressedSize = (dataLength*1.2)/8 * 8;
-            *compressBytes = (uint8_t*)malloc(estimatedCompressedSize);
+        // compressed buffer: [original size (size_t)][ZSTD frame]
+        inline uint64_t compress(const uint8_t* data, uint64_t dataLength, uint8_t** compressBytes) {
+            size_t estimatedCompressedSize = ZSTD_compressBound(dataLength);
+            *compressBytes = (uint8_t*)allocate(sizeof(size_t) + estimatedCompressedSize);
             *reinterpret_cast<size_t*>(*compressBytes) = dataLength;
-            outSize = ZSTD_compress(*compressBytes + sizeof(size_t), estimatedCompressedSize, data, dataLength, ZSTD_LEVEL); 
+            size_t outSize = ZSTD_compress(*compressBytes + sizeof(size_t), estimatedCompressedSize, data, dataLength, ZSTD_LEVEL);
+            if(ZSTD_isError(outSize)){
+                std::cerr << "ZSTD compression failed: " << ZSTD_getErrorName(outSize) << std::endl;
+                exit(-1);
+            }
             return outSize + sizeof(size_t);
         }
-        uint32_t decompress(const uint8_t* compressBytes, uint32_t cmpSize, uint8_t** oriData) {
-            uint32_t outSize = 0;
-            outSize = *reinterpret_cast<const size_t*>(compressBytes);
-            *oriData = (uint8_t*)malloc(outSize);
-            ZSTD_decompress(*oriData, outSize, compressBytes + sizeof(size_t), cmpSize - sizeof(size_t));
+        // decompress into a caller-provided buffer of at least the original size
+        inline uint64_t decompress_to(const uint8_t* compressBytes, uint64_t cmpSize, uint8_t* oriData) {
+            size_t outSize = *reinterpret_cast<const size_t*>(compressBytes);
+            size_t result = ZSTD_decompress(oriData, outSize, compressBytes + sizeof(size_t), cmpSize - sizeof(size_t));
+            if(ZSTD_isError(result) || (result != outSize)){
+                std::cerr << "ZSTD decompression failed: " << (ZSTD_isError(result) ? ZSTD_getErrorName(result) : "size mismatch") << std::endl;
+                exit(-1);
+            }
             return outSize;
         }
+        inline uint64_t decompress(const uint8_t* compressBytes, uint64_t cmpSize, uint8_t** oriData) {
+            size_t outSize = *reinterpret_cast<const size_t*>(compressBytes);
+            *oriData = (uint8_t*)allocate(outSize);
+            return decompress_to(compressBytes, cmpSize, *oriData);
+        }
     }
 }
 #endif
@@ -0,0 +1,197 @@
+#ifndef _MDR_PROFILER_HPP
+#define _MDR_PROFILER_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include "Allocator/MemoryTracker.hpp"
+
+namespace MDR {
+    // One timed pipeline stage on one level (level -1 for stages over the whole data)
+    struct ProfileRecord{
+        std::string stage;
+        int level;
+        // seconds since the profiler was created, monotonic
+        double start;
+        double duration;
+        uint64_t bytes_in;
+        uint64_t bytes_out;
+        uint64_t allocations;
+        uint32_t thread;
+    };
+
+    // Totals of all records of one stage
+    struct StageSummary{
+        uint64_t count = 0;
+        double total_time = 0;
+        uint64_t bytes_in = 0;
+        uint64_t bytes_out = 0;
+        uint64_t allocations = 0;
+    };
+
+    // Process-wide stage profiler
+    // disabled by default; setting MDR_PROFILE=<file> enables it at startup and writes the records to <file> at exit,
+    // as a Chrome trace if the file name ends with ".trace.json" and as plain JSON otherwise
+    class Profiler {
+    public:
+        static Profiler& instance(){
+            static Profiler profiler;
+            return profiler;
+        }
+        Profiler(const Profiler&) = delete;
+        Profiler& operator=(const Profiler&) = delete;
+
+        void enable(bool on = true){
+            active.store(on, std::memory_order_relaxed);
+        }
+
+        bool enabled() const {
+            return active.load(std::memory_order_relaxed);
+        }
+
+        double now() const {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - origin).count();
+        }
+
+        void record(const ProfileRecord& record){
+            std::lock_guard<std::mutex> lock(mutex);
+            profile_records.push_back(record);
+        }
+
+        std::vector<ProfileRecord> records() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return profile_records;
+        }
+
+        std::map<std::string, StageSummary> summarize() const {
+            std::map<std::string, StageSummary> summary;
+            for(const auto& r:records()){
+                StageSummary& s = summary[r.stage];
+                s.count ++;
+                s.total_time += r.duration;
+                s.bytes_in += r.bytes_in;
+                s.bytes_out += r.bytes_out;
+                s.allocations += r.allocations;
+            }
+            return summary;
+        }
+
+        void clear(){
+            std::lock_guard<std::mutex> lock(mutex);
+            profile_records.clear();
+        }
+
+        // {"records": [...], "summary": {stage: {...}}}
+        void write_json(std::ostream& out) const {
+            auto all_records = records();
+            out << "{\"records\":[";
+            for(int i=0; i<all_records.size(); i++){
+                const ProfileRecord& r = all_records[i];
+                out << (i ? "," : "") << "\n{\"stage\":\"" << r.stage << "\",\"level\":" << r.level << ",\"start\":" << r.start << ",\"duration\":" << r.duration
+                    << ",\"bytes_in\":" << r.bytes_in << ",\"bytes_out\":" << r.bytes_out << ",\"allocations\":" << r.allocations << ",\"thread\":" << r.thread << "}";
+            }
+            out << "],\n\"summary\":{";
+            bool first = true;
+            for(const auto& s:summarize()){
+                out << (first ? "" : ",") << "\n\"" << s.first << "\":{\"count\":" << s.second.count << ",\"total_time\":" << s.second.total_time
+                    << ",\"bytes_in\":" << s.second.bytes_in << ",\"bytes_out\":" << s.second.bytes_out << ",\"allocations\":" << s.second.allocations << "}";
+                first = false;
+            }
+            out << "}}" << std::endl;
+        }
+
+        // Chrome trace event format (chrome://tracing, Perfetto): one complete event per record, times in microseconds
+        void write_chrome_trace(std::ostream& out) const {
+            auto all_records = records();
+            out << "{\"traceEvents\":[";
+            for(int i=0; i<all_records.size(); i++){
+                const ProfileRecord& r = all_records[i];
+                out << (i ? "," : "") << "\n{\"name\":\"" << r.stage << "\",\"cat\":\"mdr\",\"ph\":\"X\",\"ts\":" << r.start * 1e6 << ",\"dur\":" << r.duration * 1e6
+                    << ",\"pid\":1,\"tid\":" << r.thread << ",\"args\":{\"level\":" << r.level << ",\"bytes_in\":" << r.bytes_in << ",\"bytes_out\":" << r.bytes_out << ",\"allocations\":" << r.allocations << "}}";
+            }
+            out << "],\n\"displayTimeUnit\":\"ms\"}" << std::endl;
+        }
+
+        bool dump(const std::string& filename) const {
+            std::ofstream out(filename);
+            if(!out){
+                std::cerr << "Errors in writing profile to " << filename << std::endl;
+                return false;
+            }
+            const std::string suffix = ".trace.json";
+            bool trace = (filename.size() >= suffix.size()) && (filename.compare(filename.size() - suffix.size(), suffix.size(), suffix) == 0);
+            if(trace) write_chrome_trace(out);
+            else write_json(out);
+            return true;
+        }
+
+        // small sequential id of the calling thread
+        static uint32_t thread_id(){
+            static std::atomic<uint32_t> next_id{0};
+            static thread_local uint32_t id = next_id ++;
+            return id;
+        }
+
+        ~Profiler(){
+            if(!output_file.empty()) dump(output_file);
+        }
+    private:
+        Profiler() : origin(std::chrono::steady_clock::now()) {
+            const char * env = getenv("MDR_PROFILE");
+            if(env && *env){
+                output_file = env;
+                active = true;
+            }
+        }
+
+        std::chrono::steady_clock::time_point origin;
+        std::atomic<bool> active{false};
+        std::string output_file;
+        mutable std::mutex mutex;
+        std::vector<ProfileRecord> profile_records;
+    };
+
+    // Times the enclosing scope as one stage, does nothing if profiling is disabled
+    // buffers allocated in the scope are charged to the same stage by the MemoryTracker
+    class ProfileScope {
+    public:
+        ProfileScope(const char * stage, int level = -1, uint64_t bytes_in = 0) : stage(stage), level(level), bytes_in(bytes_in), active(Profiler::instance().enabled()), memory_scope(stage, level) {
+            if(active) start = Profiler::instance().now();
+        }
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+        void set_bytes_in(uint64_t bytes){
+            bytes_in = bytes;
+        }
+        void set_bytes_out(uint64_t bytes){
+            bytes_out = bytes;
+        }
+        void add_allocations(uint64_t count){
+            allocations += count;
+        }
+
+        ~ProfileScope(){
+            if(!active) return;
+            Profiler& profiler = Profiler::instance();
+            profiler.record({stage, level, start, profiler.now() - start, bytes_in, bytes_out, allocations, Profiler::thread_id()});
+        }
+    private:
+        const char * stage;
+        int level;
+        uint64_t bytes_in;
+        uint64_t bytes_out = 0;
+        uint64_t allocations = 0;
+        bool active;
+        double start = 0;
+        MemoryScope memory_scope;
+    };
+}
+#endif
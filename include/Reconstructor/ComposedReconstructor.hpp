@@ -11,6 +11,9 @@
 #include "SizeInterpreter/SizeInterpreter.hpp"
 #include "LosslessCompressor/LevelCompressor.hpp"
 #include "RefactorUtils.hpp"
+#include "Profiler.hpp"
+#include "Allocator/Allocator.hpp"
+#include <numeric>
 
 
 namespace MDR {
@@ -23,95 +26,127 @@ namespace MDR {
 
         // reconstruct data from encoded streams
         T * reconstruct(double tolerance){
-            Timer timer;
-            timer.start();
-            std::vector<std::vector<double>> level_abs_errors;
-            uint8_t target_level = level_error_bounds.size() - 1;
-            std::vector<std::vector<double>>& level_errors = level_squared_errors;
-            if(std::is_base_of<MaxErrorEstimator<T>, ErrorEstimator>::value){
-                //std::cout << "ErrorEstimator is base of MaxErrorEstimator, computing absolute error" << std::endl;
-                MaxErrorCollector<T> collector = MaxErrorCollector<T>();
-                for(int i=0; i<=target_level; i++){
-                    auto collected_error = collector.collect_level_error(NULL, 0, level_squared_errors[i].size(), level_error_bounds[i]);
-                    level_abs_errors.push_back(collected_error);
-                }
-                level_errors = level_abs_errors;
+            std::vector<uint8_t> prev_level_num_bitplanes(level_num_bitplanes);
+            std::vector<uint64_t> retrieve_sizes;
+            std::vector<std::vector<double>> level_errors;
+            {
+                ProfileScope scope("interpret");
+                level_errors = compute_estimator_level_errors<T, ErrorEstimator>(level_error_bounds, level_squared_errors);
+                retrieve_sizes = interpreter.interpret_retrieve_size(level_sizes, level_errors, tolerance, level_num_bitplanes);
             }
-            else if(std::is_base_of<SquaredErrorEstimator<T>, ErrorEstimator>::value){
-                std::cout << "ErrorEstimator is base of SquaredErrorEstimator, using level squared error directly" << std::endl;
-            }
-            else{
-                std::cerr << "Customized error estimator not supported yet" << std::endl;
-                exit(-1);
-            }
-            timer.end();
-            //timer.print("Preprocessing");            
-
-            timer.start();
-            auto prev_level_num_bitplanes(level_num_bitplanes);
-            auto retrieve_sizes = interpreter.interpret_retrieve_size(level_sizes, level_errors, tolerance, level_num_bitplanes);
             // retrieve data
-            level_components = retriever.retrieve_level_components(level_sizes, retrieve_sizes, prev_level_num_bitplanes, level_num_bitplanes);
-            // check whether to reconstruct to full resolution
-            int skipped_level = 0;
-            for(int i=0; i<=target_level; i++){
-                if(level_num_bitplanes[target_level - i] != 0){
-                    skipped_level = i;
+            if(!retrieve(retrieve_sizes, prev_level_num_bitplanes)) return NULL;
+            // speculatively interpret the next refinement so that the retriever reads it during reconstruction
+            for(const auto& next_tolerance:prefetch_schedule){
+                if(next_tolerance < tolerance){
+                    auto next_level_num_bitplanes(level_num_bitplanes);
+                    interpreter.set_quiet(true);
+                    auto next_retrieve_sizes = interpreter.interpret_retrieve_size(level_sizes, level_errors, next_tolerance, next_level_num_bitplanes);
+                    interpreter.set_quiet(false);
+                    retriever.prefetch(next_retrieve_sizes);
                     break;
                 }
             }
-            // TODO: uncomment skip level to reconstruct low resolution data
-            // target_level -= skipped_level;
-            timer.end();
-            //timer.print("Interpret and retrieval");
+            return reconstruct_retrieved(prev_level_num_bitplanes);
+        }
 
-            bool success = reconstruct(target_level, prev_level_num_bitplanes);
-            retriever.release();
-            if(success) return data.data();
-            else{
-                std::cerr << "Reconstruct unsuccessful, return NULL pointer" << std::endl;
+        // reconstruct data up to the given number of bitplanes per level, e.g. decided jointly for several variables
+        T * reconstruct(const std::vector<uint8_t>& target_level_num_bitplanes){
+            bool valid = (target_level_num_bitplanes.size() == level_sizes.size());
+            for(int i=0; valid && (i<level_sizes.size()); i++){
+                valid = (target_level_num_bitplanes[i] <= level_sizes[i].size());
+            }
+            if(!valid){
+                std::cerr << "Target bitplanes do not match the levels in metadata, return NULL pointer" << std::endl;
                 return NULL;
             }
+            auto prev_level_num_bitplanes(level_num_bitplanes);
+            std::vector<uint64_t> retrieve_sizes(level_sizes.size(), 0);
+            for(int i=0; i<level_sizes.size(); i++){
+                for(int j=prev_level_num_bitplanes[i]; j<target_level_num_bitplanes[i]; j++){
+                    retrieve_sizes[i] += level_sizes[i][j];
+                }
+                level_num_bitplanes[i] = std::max(prev_level_num_bitplanes[i], target_level_num_bitplanes[i]);
+            }
+            if(!retrieve(retrieve_sizes, prev_level_num_bitplanes)) return NULL;
+            return reconstruct_retrieved(prev_level_num_bitplanes);
         }
 
         // reconstruct progressively based on available data
         T * progressive_reconstruct(double tolerance){
             std::vector<T> cur_data(data);
-            reconstruct(tolerance);
-            // TODO: add resolution changes
-            if(cur_data.size() == data.size()){
-                for(int i=0; i<data.size(); i++){
-                    data[i] += cur_data[i];
-                }                
-            }
-            else if(cur_data.size()){
-                std::cerr << "Reconstruct size changes, not supported yet." << std::endl;
-                std::cerr << "Sizes before reconstruction: " << cur_data.size() << std::endl;
-                std::cerr << "Sizes after reconstruction: " << data.size() << std::endl;
-                exit(0);
-            }
-            return data.data();
+            if(reconstruct(tolerance) == NULL) return NULL;
+            return accumulate(cur_data);
+        }
+
+        T * progressive_reconstruct(const std::vector<uint8_t>& target_level_num_bitplanes){
+            std::vector<T> cur_data(data);
+            if(reconstruct(target_level_num_bitplanes) == NULL) return NULL;
+            return accumulate(cur_data);
         }
 
         void load_metadata(){
             uint8_t * metadata = retriever.load_metadata();
             uint8_t const * metadata_pos = metadata;
+            uint8_t version = read_metadata_header(metadata_pos);
             uint8_t num_dims = *(metadata_pos ++);
             deserialize(metadata_pos, num_dims, dimensions);
             uint8_t num_levels = *(metadata_pos ++);
             deserialize(metadata_pos, num_levels, level_error_bounds);
             deserialize(metadata_pos, num_levels, level_squared_errors);
-            deserialize(metadata_pos, num_levels, level_sizes);
-            deserialize(metadata_pos, num_levels, stopping_indices);
+            if(version == 1){
+                // 32-bit level sizes and one stopping index per level
+                std::vector<std::vector<uint32_t>> legacy_level_sizes;
+                std::vector<uint8_t> stopping_indices;
+                deserialize(metadata_pos, num_levels, legacy_level_sizes);
+                deserialize(metadata_pos, num_levels, stopping_indices);
+                level_sizes.clear();
+                level_compressed_flags.clear();
+                for(int i=0; i<num_levels; i++){
+                    level_sizes.push_back(std::vector<uint64_t>(legacy_level_sizes[i].begin(), legacy_level_sizes[i].end()));
+                    level_compressed_flags.push_back(compressor.legacy_compressed_flags(stopping_indices[i], legacy_level_sizes[i].size()));
+                }
+            }
+            else{
+                deserialize(metadata_pos, num_levels, level_sizes);
+                deserialize(metadata_pos, num_levels, level_compressed_flags);
+            }
             deserialize(metadata_pos, num_levels, level_num);
+            if((version >= 3) && *(metadata_pos ++)){
+                RateDistortionIndex rd_index;
+                rd_index.deserialize(metadata_pos, version);
+                interpreter.load_rate_distortion_index(rd_index);
+            }
             level_num_bitplanes = std::vector<uint8_t>(num_levels, 0);
-            free(metadata);
+            deallocate(metadata);
+        }
+
+        // tolerances of upcoming requests: after each retrieval, the first one tighter than the current tolerance is prefetched
+        void set_prefetch_schedule(const std::vector<double>& tolerances){
+            prefetch_schedule = tolerances;
         }
 
         const std::vector<uint32_t>& get_dimensions(){
             return dimensions;
         }
 
+        T * get_data(){
+            return data.data();
+        }
+
+        const std::vector<std::vector<uint64_t>>& get_level_sizes() const {
+            return level_sizes;
+        }
+
+        // level errors in the form used by the error estimator
+        std::vector<std::vector<double>> get_level_errors() const {
+            return compute_estimator_level_errors<T, ErrorEstimator>(level_error_bounds, level_squared_errors);
+        }
+
+        const std::vector<uint8_t>& get_level_num_bitplanes() const {
+            return level_num_bitplanes;
+        }
+
         ~ComposedReconstructor(){}
 
         void print() const {
@@ -123,46 +158,116 @@ namespace MDR {
             std::cout << "Retriever: "; retriever.print();
         }
     private:
+        // a failed retrieval keeps the previous bitplanes so that the request can be repeated
+        bool retrieve(const std::vector<uint64_t>& retrieve_sizes, const std::vector<uint8_t>& prev_level_num_bitplanes){
+            uint64_t retrieved_size = std::accumulate(retrieve_sizes.begin(), retrieve_sizes.end(), (uint64_t) 0);
+            ProfileScope scope("retrieve", -1, retrieved_size);
+            Timer retrieval_timer;
+            retrieval_timer.start();
+            level_components = retriever.retrieve_level_components(level_sizes, retrieve_sizes, prev_level_num_bitplanes, level_num_bitplanes);
+            retrieval_timer.end();
+            if(level_components.size() != level_sizes.size()){
+                std::cerr << "Retrieve unsuccessful, return NULL pointer" << std::endl;
+                level_num_bitplanes = prev_level_num_bitplanes;
+                retriever.release();
+                release_level(-1);
+                return false;
+            }
+            scope.set_bytes_out(retrieved_size);
+            interpreter.record_retrieval(retrieved_size, retrieval_timer.get());
+            return true;
+        }
+
+        T * reconstruct_retrieved(const std::vector<uint8_t>& prev_level_num_bitplanes){
+            uint8_t target_level = level_error_bounds.size() - 1;
+            // check whether to reconstruct to full resolution
+            int skipped_level = 0;
+            for(int i=0; i<=target_level; i++){
+                if(level_num_bitplanes[target_level - i] != 0){
+                    skipped_level = i;
+                    break;
+                }
+            }
+            // TODO: uncomment skip level to reconstruct low resolution data
+            // target_level -= skipped_level;
+
+            bool success = reconstruct(target_level, prev_level_num_bitplanes);
+            retriever.release();
+            // retrieved buffers are not attributed to a level
+            release_level(-1);
+            if(success) return data.data();
+            else{
+                std::cerr << "Reconstruct unsuccessful, return NULL pointer" << std::endl;
+                return NULL;
+            }
+        }
+
+        // add the previous reconstruction to the refinement just reconstructed
+        T * accumulate(const std::vector<T>& cur_data){
+            // TODO: add resolution changes
+            if(cur_data.size() == data.size()){
+                for(int i=0; i<data.size(); i++){
+                    data[i] += cur_data[i];
+                }                
+            }
+            else if(cur_data.size()){
+                std::cerr << "Reconstruct size changes, not supported yet." << std::endl;
+                std::cerr << "Sizes before reconstruction: " << cur_data.size() << std::endl;
+                std::cerr << "Sizes after reconstruction: " << data.size() << std::endl;
+                exit(0);
+            }
+            return data.data();
+        }
+
         bool reconstruct(uint8_t target_level, const std::vector<uint8_t>& prev_level_num_bitplanes, bool progressive=true){
-            Timer timer;
-            timer.start();
             auto level_dims = compute_level_dims(dimensions, target_level);
             auto reconstruct_dimensions = level_dims[target_level];
-            uint32_t num_elements = 1;
+            size_t num_elements = 1;
             for(const auto& dim:reconstruct_dimensions){
                 num_elements *= dim;
             }
             data.clear();
             data = std::vector<T>(num_elements, 0);
-            timer.end();
-            //timer.print("Reconstruct Preprocessing");            
 
             auto level_elements = compute_level_elements(level_dims, target_level);
             std::vector<uint32_t> dims_dummy(reconstruct_dimensions.size(), 0);
             for(int i=0; i<=target_level; i++){
-                timer.start();
-                compressor.decompress_level(level_components[i], level_sizes[i], prev_level_num_bitplanes[i], level_num_bitplanes[i] - prev_level_num_bitplanes[i], stopping_indices[i]);
-                timer.end();
-                //timer.print("Lossless");            
-                timer.start();
-                int level_exp = 0;
-                frexp(level_error_bounds[i], &level_exp);
-                auto level_decoded_data = encoder.progressive_decode(level_components[i], level_elements[i], level_exp, prev_level_num_bitplanes[i], level_num_bitplanes[i] - prev_level_num_bitplanes[i], i);
-                compressor.decompress_release();
-                timer.end();
-                //timer.print("Decoding");
-
-                timer.start();
-                const std::vector<uint32_t>& prev_dims = (i == 0) ? dims_dummy : level_dims[i - 1];
-                interleaver.reposition(level_decoded_data, reconstruct_dimensions, level_dims[i], prev_dims, data.data());
-                free(level_decoded_data);
-                timer.end();
-                //timer.print("Reposition");            
-            }
-            timer.start();
-            decomposer.recompose(data.data(), reconstruct_dimensions, target_level);
-            timer.end();
-            //timer.print("Recomposing");            
+                const int num_bitplanes = level_num_bitplanes[i] - prev_level_num_bitplanes[i];
+                const uint64_t level_bytes = level_elements[i] * sizeof(T);
+                {
+                    uint64_t retrieved_size = 0;
+                    uint64_t num_compressed = 0;
+                    for(int j=prev_level_num_bitplanes[i]; j<level_num_bitplanes[i]; j++){
+                        retrieved_size += level_sizes[i][j];
+                        num_compressed += level_compressed_flags[i][j];
+                    }
+                    ProfileScope scope("decompress", i, retrieved_size);
+                    compressor.decompress_level(level_components[i], level_sizes[i], prev_level_num_bitplanes[i], num_bitplanes, level_compressed_flags[i]);
+                    scope.add_allocations(num_compressed);
+                }
+                T * level_decoded_data = NULL;
+                {
+                    ProfileScope scope("decode", i);
+                    int level_exp = 0;
+                    frexp(level_error_bounds[i], &level_exp);
+                    level_decoded_data = encoder.progressive_decode(level_components[i], level_elements[i], level_exp, prev_level_num_bitplanes[i], num_bitplanes, i);
+                    compressor.decompress_release();
+                    scope.set_bytes_out(level_bytes);
+                    scope.add_allocations(1);
+                }
+                {
+                    ProfileScope scope("reposition", i, level_bytes);
+                    const std::vector<uint32_t>& prev_dims = (i == 0) ? dims_dummy : level_dims[i - 1];
+                    interleaver.reposition(level_decoded_data, reconstruct_dimensions, level_dims[i], prev_dims, data.data());
+                    deallocate(level_decoded_data);
+                }
+                release_level(i);
+            }
+            {
+                ProfileScope scope("recompose", -1, num_elements * sizeof(T));
+                decomposer.recompose(data.data(), reconstruct_dimensions, target_level);
+                scope.set_bytes_out(num_elements * sizeof(T));
+            }
             return true;
         }
 
@@ -176,11 +281,12 @@ namespace MDR {
         std::vector<uint32_t> dimensions;
         std::vector<T> level_error_bounds;
         std::vector<uint8_t> level_num_bitplanes;
-        std::vector<uint8_t> stopping_indices;
+        std::vector<std::vector<uint8_t>> level_compressed_flags;
         std::vector<std::vector<const uint8_t*>> level_components;
-        std::vector<std::vector<uint32_t>> level_sizes;
+        std::vector<std::vector<uint64_t>> level_sizes;
         std::vector<uint32_t> level_num;
         std::vector<std::vector<double>> level_squared_errors;
+        std::vector<double> prefetch_schedule;
     };
 }
 #endif
@@ -0,0 +1,138 @@
+#ifndef _MDR_MULTI_VARIABLE_RECONSTRUCTOR_HPP
+#define _MDR_MULTI_VARIABLE_RECONSTRUCTOR_HPP
+
+#include "ComposedReconstructor.hpp"
+#include "ThreadPool.hpp"
+#include <memory>
+#include <limits>
+#include <queue>
+
+namespace MDR {
+    // Joint retrieval of several variables
+    // one greedy scheduler over the (variable, level) bitplanes of all variables decides what to retrieve under a global byte budget
+    // and/or per-variable tolerances; the variables are then retrieved and reconstructed concurrently in one wave
+    class MultiVariableReconstructor {
+    public:
+        MultiVariableReconstructor(int num_threads = std::thread::hardware_concurrency()) : pool(num_threads) {}
+
+        // the reconstructor must have loaded its metadata and outlive this object
+        // weight scales the estimated error of this variable when variables compete for the budget
+        template<class Reconstructor, class ErrorEstimator>
+        void add_variable(Reconstructor& reconstructor, const ErrorEstimator& estimator, double weight = 1.0){
+            variables.push_back(std::unique_ptr<Variable>(new ComposedVariable<Reconstructor, ErrorEstimator>(reconstructor, estimator, weight)));
+        }
+
+        // retrieve at most budget bytes in total; variable i stops once its estimated error is below tolerances[i] (if given)
+        // reconstructed data is read from each reconstructor with get_data(); returns false if any variable fails
+        bool progressive_reconstruct(uint64_t budget, const std::vector<double>& tolerances = std::vector<double>()){
+            const int num_variables = variables.size();
+            if(!tolerances.empty() && (tolerances.size() != num_variables)){
+                std::cerr << "Number of tolerances (" << tolerances.size() << ") does not match the number of variables (" << num_variables << ")" << std::endl;
+                return false;
+            }
+            std::vector<std::vector<uint8_t>> index;
+            std::vector<double> accumulated_errors(num_variables, 0);
+            std::priority_queue<VariableUnitErrorGain> heap;
+            for(int v=0; v<num_variables; v++){
+                const Variable& var = *variables[v];
+                index.push_back(var.level_num_bitplanes());
+                for(int i=0; i<index[v].size(); i++){
+                    accumulated_errors[v] += var.estimate_error(var.level_errors[i][index[v][i]], i);
+                }
+                for(int i=0; i<index[v].size(); i++){
+                    push(heap, v, i, index[v][i], accumulated_errors[v]);
+                }
+            }
+            uint64_t remaining_budget = budget;
+            while(!heap.empty()){
+                auto unit_error_gain = heap.top();
+                heap.pop();
+                int v = unit_error_gain.variable;
+                int i = unit_error_gain.level;
+                const Variable& var = *variables[v];
+                if((v < tolerances.size()) && (accumulated_errors[v] < tolerances[v])) continue;
+                int j = index[v][i];
+                // bitplanes of a level are retrieved in order: a level stops once its next bitplane does not fit
+                if(var.level_sizes()[i][j] > remaining_budget) continue;
+                remaining_budget -= var.level_sizes()[i][j];
+                accumulated_errors[v] -= var.estimate_error(var.level_errors[i][j], i);
+                accumulated_errors[v] += var.estimate_error(var.level_errors[i][j + 1], i);
+                index[v][i] ++;
+                push(heap, v, i, index[v][i], accumulated_errors[v]);
+            }
+            // issue the retrieval of all variables at once
+            std::vector<std::future<bool>> tasks;
+            for(int v=0; v<num_variables; v++){
+                Variable * var = variables[v].get();
+                const std::vector<uint8_t>& target = index[v];
+                tasks.push_back(pool.submit([var, &target](){ return var->progressive_reconstruct(target); }));
+            }
+            bool success = true;
+            for(auto& t:tasks) success = t.get() && success;
+            return success;
+        }
+
+        // per-variable tolerances without a byte budget
+        bool progressive_reconstruct(const std::vector<double>& tolerances){
+            return progressive_reconstruct(std::numeric_limits<uint64_t>::max(), tolerances);
+        }
+
+        void print() const {
+            std::cout << "Multi-variable reconstructor with " << variables.size() << " variables." << std::endl;
+        }
+    private:
+        struct Variable{
+            Variable(double weight) : weight(weight) {}
+            virtual ~Variable() = default;
+            virtual const std::vector<std::vector<uint64_t>>& level_sizes() const = 0;
+            virtual const std::vector<uint8_t>& level_num_bitplanes() const = 0;
+            virtual double estimate_error(double error, int level) const = 0;
+            virtual double estimate_error_gain(double base, double current_level_err, double next_level_err, int level) const = 0;
+            virtual bool progressive_reconstruct(const std::vector<uint8_t>& target_level_num_bitplanes) = 0;
+            double weight;
+            std::vector<std::vector<double>> level_errors;
+        };
+        template<class Reconstructor, class ErrorEstimator>
+        struct ComposedVariable : public Variable{
+            ComposedVariable(Reconstructor& reconstructor, const ErrorEstimator& estimator, double weight) : Variable(weight), reconstructor(reconstructor), estimator(estimator) {
+                this->level_errors = reconstructor.get_level_errors();
+            }
+            const std::vector<std::vector<uint64_t>>& level_sizes() const {
+                return reconstructor.get_level_sizes();
+            }
+            const std::vector<uint8_t>& level_num_bitplanes() const {
+                return reconstructor.get_level_num_bitplanes();
+            }
+            double estimate_error(double error, int level) const {
+                return estimator.estimate_error(error, level);
+            }
+            double estimate_error_gain(double base, double current_level_err, double next_level_err, int level) const {
+                return estimator.estimate_error_gain(base, current_level_err, next_level_err, level);
+            }
+            bool progressive_reconstruct(const std::vector<uint8_t>& target_level_num_bitplanes){
+                return reconstructor.progressive_reconstruct(target_level_num_bitplanes) != NULL;
+            }
+            Reconstructor& reconstructor;
+            ErrorEstimator estimator;
+        };
+        struct VariableUnitErrorGain{
+            double unit_error_gain;
+            int variable;
+            int level;
+            bool operator<(const VariableUnitErrorGain& other) const {
+                return unit_error_gain < other.unit_error_gain;
+            }
+        };
+
+        void push(std::priority_queue<VariableUnitErrorGain>& heap, int v, int i, int j, double accumulated_error) const {
+            const Variable& var = *variables[v];
+            if(j == var.level_sizes()[i].size()) return;
+            double error_gain = var.weight * var.estimate_error_gain(accumulated_error, var.level_errors[i][j], var.level_errors[i][j + 1], i);
+            heap.push({error_gain / var.level_sizes()[i][j], v, i});
+        }
+
+        std::vector<std::unique_ptr<Variable>> variables;
+        ThreadPool pool;
+    };
+}
+#endif
@@ -2,5 +2,7 @@
 #define _MDR_RECONSTRUCTOR_HPP
 
 #include "ComposedReconstructor.hpp"
+#include "MultiVariableReconstructor.hpp"
+#include "TiledReconstructor.hpp"
 
 #endif
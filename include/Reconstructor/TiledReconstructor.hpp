@@ -0,0 +1,94 @@
+#ifndef _MDR_TILED_RECONSTRUCTOR_HPP
+#define _MDR_TILED_RECONSTRUCTOR_HPP
+
+#include "ComposedReconstructor.hpp"
+#include "ThreadPool.hpp"
+#include "Allocator/Allocator.hpp"
+#include <memory>
+
+namespace MDR {
+    // Reconstructor for data refactored by TiledRefactor: tiles are reconstructed independently on a thread pool and assembled
+    template<class T, class Decomposer, class Interleaver, class Encoder, class Compressor, class SizeInterpreter, class ErrorEstimator>
+    class TiledReconstructor {
+    public:
+        TiledReconstructor(Decomposer decomposer, Interleaver interleaver, Encoder encoder, Compressor compressor, SizeInterpreter interpreter, const std::string& container_file, int num_threads = std::thread::hardware_concurrency())
+            : decomposer(decomposer), interleaver(interleaver), encoder(encoder), compressor(compressor), interpreter(interpreter), container_file(container_file), pool(num_threads) {}
+
+        void load_metadata(){
+            ContainerFileRetriever tiling_retriever(container_file, MDR_TILING_RECORD);
+            uint8_t * tiling = tiling_retriever.load_metadata();
+            uint8_t const * tiling_pos = tiling;
+            uint8_t num_dims = *(tiling_pos ++);
+            deserialize(tiling_pos, num_dims, dimensions);
+            uint32_t num_tiles = *reinterpret_cast<const uint32_t*>(tiling_pos);
+            tiling_pos += sizeof(uint32_t);
+            deserialize(tiling_pos, num_tiles, tile_offsets);
+            deserialize(tiling_pos, num_tiles, tile_sizes);
+            deallocate(tiling);
+            tiles.clear();
+            for(int i=0; i<num_tiles; i++){
+                tiles.push_back(std::unique_ptr<TileReconstructor>(new TileReconstructor(decomposer, interleaver, encoder, compressor, interpreter, ContainerFileRetriever(container_file, tile_name(i)))));
+                tiles.back()->load_metadata();
+            }
+            size_t num_elements = 1;
+            for(const auto& d:dimensions) num_elements *= d;
+            data = std::vector<T>(num_elements, 0);
+        }
+
+        // the tolerance applies to every tile for max errors and is split by tile volume for squared errors
+        // the split is only valid for squared-error-additive estimators, whose tile estimates add up to the global one
+        // (e.g. L2ErrorEstimator_HB); an s-norm with s != 0 weights the levels of each tile hierarchy, not the global levels
+        // returns NULL if any tile fails
+        T * progressive_reconstruct(double tolerance){
+            const bool additive = std::is_base_of<SquaredErrorEstimator<T>, ErrorEstimator>::value;
+            std::vector<std::future<bool>> tasks;
+            for(int i=0; i<tiles.size(); i++){
+                double tile_tolerance = tolerance;
+                if(additive) tile_tolerance = tolerance * tile_elements(i) / data.size();
+                tasks.push_back(pool.submit([this, i, tile_tolerance](){
+                    T * tile_data = tiles[i]->progressive_reconstruct(tile_tolerance);
+                    if(tile_data == NULL) return false;
+                    insert_tile(tile_data, dimensions, tile_offsets[i], tile_sizes[i], data.data());
+                    return true;
+                }));
+            }
+            bool success = true;
+            for(auto& t:tasks) success = t.get() && success;
+            if(success) return data.data();
+            else{
+                std::cerr << "Reconstruct unsuccessful, return NULL pointer" << std::endl;
+                return NULL;
+            }
+        }
+
+        const std::vector<uint32_t>& get_dimensions(){
+            return dimensions;
+        }
+
+        void print() const {
+            std::cout << "Tiled reconstructor with " << tiles.size() << " tiles." << std::endl;
+        }
+    private:
+        typedef ComposedReconstructor<T, Decomposer, Interleaver, Encoder, Compressor, SizeInterpreter, ErrorEstimator, ContainerFileRetriever> TileReconstructor;
+
+        size_t tile_elements(int i) const {
+            size_t num_elements = 1;
+            for(const auto& d:tile_sizes[i]) num_elements *= d;
+            return num_elements;
+        }
+
+        Decomposer decomposer;
+        Interleaver interleaver;
+        Encoder encoder;
+        Compressor compressor;
+        SizeInterpreter interpreter;
+        std::string container_file;
+        std::vector<uint32_t> dimensions;
+        std::vector<std::vector<uint32_t>> tile_offsets;
+        std::vector<std::vector<uint32_t>> tile_sizes;
+        std::vector<std::unique_ptr<TileReconstructor>> tiles;
+        std::vector<T> data;
+        ThreadPool pool;
+    };
+}
+#endif
@@ -0,0 +1,47 @@
+#ifndef _MDR_BATCH_REFACTOR_HPP
+#define _MDR_BATCH_REFACTOR_HPP
+
+#include "ComposedRefactor.hpp"
+#include "Writer/BatchContainerWriter.hpp"
+#include "ThreadPool.hpp"
+
+namespace MDR {
+    // Refactor many variables into one batch container
+    // each variable is refactored by its own composed refactor, scheduled on a shared thread pool as soon as it is added
+    // variables are read back with ContainerFileRetriever(container_file, name)
+    class BatchRefactor {
+    public:
+        BatchRefactor(const std::string& container_file, int num_threads = std::thread::hardware_concurrency(), uint64_t alignment = 4096)
+            : container(std::make_shared<BatchContainerFile>(container_file, alignment)), pool(num_threads) {}
+
+        // data must stay valid until finalize() returns
+        template<class T, class Decomposer, class Interleaver, class Encoder, class Compressor, class ErrorCollector>
+        void add_variable(const std::string& name, T const * data, const std::vector<uint32_t>& dims, uint8_t target_level, uint8_t num_bitplanes, Decomposer decomposer, Interleaver interleaver, Encoder encoder, Compressor compressor, ErrorCollector collector){
+            typedef ComposedRefactor<T, Decomposer, Interleaver, Encoder, Compressor, ErrorCollector, BatchVariableWriter> Refactor;
+            auto refactor = std::make_shared<Refactor>(decomposer, interleaver, encoder, compressor, collector, BatchVariableWriter(container, name));
+            tasks.push_back(pool.submit([refactor, data, dims, target_level, num_bitplanes](){
+                refactor->refactor(data, dims, target_level, num_bitplanes);
+            }));
+        }
+
+        // wait for all variables and write the variable index
+        void finalize(){
+            for(auto& t:tasks) t.get();
+            tasks.clear();
+            container->finalize();
+        }
+
+        ~BatchRefactor(){
+            for(auto& t:tasks) t.wait();
+        }
+
+        void print() const {
+            std::cout << "Batch refactor with " << pool.size() << " threads." << std::endl;
+        }
+    private:
+        std::shared_ptr<BatchContainerFile> container;
+        ThreadPool pool;
+        std::vector<std::future<void>> tasks;
+    };
+}
+#endif
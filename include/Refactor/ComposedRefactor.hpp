@@ -8,7 +8,12 @@
 #include "ErrorCollector/ErrorCollector.hpp"
 #include "LosslessCompressor/LevelCompressor.hpp"
 #include "Writer/Writer.hpp"
+#include "SizeInterpreter/RateDistortionIndex.hpp"
 #include "RefactorUtils.hpp"
+#include "Profiler.hpp"
+#include "Allocator/Allocator.hpp"
+#include <functional>
+#include <numeric>
 
 namespace MDR {
     // a decomposition-based scientific data refactor: compose a refactor using decomposer, interleaver, encoder, and error collector
@@ -20,49 +25,56 @@ namespace MDR {
 
         void refactor(T const * data_, const std::vector<uint32_t>& dims, uint8_t target_level, uint8_t num_bitplanes){
             //std::cout << "Refactor" << std::endl;
-            Timer timer;
-            timer.start();
-            dimensions = dims;
-            uint32_t num_elements = 1;
-            for(const auto& dim:dimensions){
+            size_t num_elements = 1;
+            for(const auto& dim:dims){
                 num_elements *= dim;
             }
             data = std::vector<T>(data_, data_ + num_elements);
             //std::cout << "Refactor" << std::endl;
-            
-            //// if refactor successfully
-            if(refactor(target_level, num_bitplanes)){
-                timer.end();
-                //timer.print("Refactor");
-                timer.start();
-                level_num = writer.write_level_components(level_components, level_sizes);
-                timer.end();
-            }
+            refactor_buffer(data.data(), dims, target_level, num_bitplanes);
+        }
 
-            write_metadata();
-            for(int i=0; i<level_components.size(); i++){
-                for(int j=0; j<level_components[i].size(); j++){
-                    free(level_components[i][j]);
-                }
-            }
+        // take ownership of the input and decompose it without a copy
+        void refactor(std::vector<T>&& data_, const std::vector<uint32_t>& dims, uint8_t target_level, uint8_t num_bitplanes){
+            data = std::move(data_);
+            refactor_buffer(data.data(), dims, target_level, num_bitplanes);
+        }
+
+        // decompose the caller's buffer in place: its contents are overwritten by the decomposition
+        void refactor_in_place(T * data_, const std::vector<uint32_t>& dims, uint8_t target_level, uint8_t num_bitplanes){
+            refactor_buffer(data_, dims, target_level, num_bitplanes);
         }
 
         void write_metadata() const {
-            uint32_t metadata_size = sizeof(uint8_t) + get_size(dimensions) // dimensions
+            uint64_t metadata_size = sizeof(uint32_t) + sizeof(uint8_t) // header
+                        + sizeof(uint8_t) + get_size(dimensions) // dimensions
                         + sizeof(uint8_t) + get_size(level_error_bounds) + get_size(level_squared_errors) + get_size(level_sizes) // level information
-                        + get_size(stopping_indices) + get_size(level_num);
-            uint8_t * metadata = (uint8_t *) malloc(metadata_size);
+                        + get_size(level_compressed_flags) + get_size(level_num)
+                        + sizeof(uint8_t) + (rd_index.empty() ? 0 : rd_index.get_size()); // rate-distortion index
+            uint8_t * metadata = (uint8_t *) allocate(metadata_size);
             uint8_t * metadata_pos = metadata;
+            write_metadata_header(metadata_pos);
             *(metadata_pos ++) = (uint8_t) dimensions.size();
             serialize(dimensions, metadata_pos);
             *(metadata_pos ++) = (uint8_t) level_error_bounds.size();
             serialize(level_error_bounds, metadata_pos);
             serialize(level_squared_errors, metadata_pos);
             serialize(level_sizes, metadata_pos);
-            serialize(stopping_indices, metadata_pos);
+            serialize(level_compressed_flags, metadata_pos);
             serialize(level_num, metadata_pos);
+            *(metadata_pos ++) = (uint8_t) !rd_index.empty();
+            if(!rd_index.empty()) rd_index.serialize(metadata_pos);
             writer.write_metadata(metadata, metadata_size);
-            free(metadata);
+            deallocate(metadata);
+        }
+
+        // precompute the greedy retrieval order for this error estimator and store it in metadata
+        template<class ErrorEstimator>
+        void set_rate_distortion_estimator(const ErrorEstimator& estimator){
+            build_rd_index = [estimator](const std::vector<T>& level_error_bounds, const std::vector<std::vector<double>>& level_squared_errors, const std::vector<std::vector<uint64_t>>& level_sizes){
+                auto level_errors = compute_estimator_level_errors<T, ErrorEstimator>(level_error_bounds, level_squared_errors);
+                return build_rate_distortion_index(level_sizes, level_errors, estimator);
+            };
         }
 
         ~ComposedRefactor(){}
@@ -75,7 +87,36 @@ namespace MDR {
         }
 
     private:
-        bool refactor(uint8_t target_level, uint8_t num_bitplanes){
+        void refactor_buffer(T * buffer, const std::vector<uint32_t>& dims, uint8_t target_level, uint8_t num_bitplanes){
+            dimensions = dims;
+            //// if refactor successfully
+            bool success = refactor(buffer, target_level, num_bitplanes);
+            // coefficients are no longer needed once all levels are encoded
+            std::vector<T>().swap(data);
+            if(success && !writer.streaming()){
+                ProfileScope scope("write");
+                // e.g. lay out the bitplanes in the retrieval order
+                writer.load_rate_distortion_index(rd_index);
+                level_num = writer.write_level_components(level_components, level_sizes);
+                uint64_t total_size = 0;
+                for(const auto& sizes:level_sizes) total_size += std::accumulate(sizes.begin(), sizes.end(), (uint64_t) 0);
+                scope.set_bytes_in(total_size);
+            }
+
+            {
+                ProfileScope scope("write_metadata");
+                write_metadata();
+            }
+            for(int i=0; i<level_components.size(); i++){
+                for(int j=0; j<level_components[i].size(); j++){
+                    deallocate(level_components[i][j]);
+                }
+                release_level(i);
+            }
+            level_components.clear();
+        }
+
+        bool refactor(T * data_, uint8_t target_level, uint8_t num_bitplanes){
             //std::cout << "refactor..." << std::endl;
             uint8_t max_level = log2(*min_element(dimensions.begin(), dimensions.end())) - 1;
             if(target_level > max_level){
@@ -85,17 +126,21 @@ namespace MDR {
             //std::cout << "testing..." << std::endl;
             
             //// decompose data hierarchically
-            Timer timer;
-            timer.start();
-            decomposer.decompose(data.data(), dimensions, target_level);
-            timer.end();
-            //timer.print("Decompose");
+            {
+                uint64_t num_elements = 1;
+                for(const auto& dim:dimensions) num_elements *= dim;
+                ProfileScope scope("decompose", -1, num_elements * sizeof(T));
+                decomposer.decompose(data_, dimensions, target_level);
+                scope.set_bytes_out(num_elements * sizeof(T));
+            }
 
             //// encode level by level
             level_error_bounds.clear();
             level_squared_errors.clear();
+            level_compressed_flags.clear();
             level_components.clear();
             level_sizes.clear();
+            level_num.clear();
             auto level_dims = compute_level_dims(dimensions, target_level);
             auto level_elements = compute_level_elements(level_dims, target_level);
             std::vector<uint32_t> dims_dummy(dimensions.size(), 0);
@@ -105,51 +150,82 @@ namespace MDR {
             //std::cout << "target_level="<< std::to_string(target_level) << std::endl;
             for(int i=0; i<=target_level; i++){
                 //std::cout << "i="<< std::to_string(i) << std::endl;
-                timer.start();
-                const std::vector<uint32_t>& prev_dims = (i == 0) ? dims_dummy : level_dims[i - 1];
-                T * buffer = (T *) malloc(level_elements[i] * sizeof(T));
-                //std::cout << std::to_string(level_elements[i]) << std::endl;
-                
-                //// extract level i component
-                interleaver.interleave(data.data(), dimensions, level_dims[i], prev_dims, reinterpret_cast<T*>(buffer));
-                //std::cout << std::to_string(level_elements[i]) << std::endl;
-                
-                //// compute max coefficient as level error bound
-                //std::cout << "there" << std::endl;
-                T level_max_error = compute_max_abs_value(reinterpret_cast<T*>(buffer), level_elements[i]);
-                // std::cout << std::to_string(level_elements[i]) << std::endl;
-                level_error_bounds.push_back(level_max_error);
-                timer.end();
-                //timer.print("Interleave");
+                const uint64_t level_bytes = level_elements[i] * sizeof(T);
+                T * buffer = NULL;
+                {
+                    ProfileScope scope("interleave", i);
+                    const std::vector<uint32_t>& prev_dims = (i == 0) ? dims_dummy : level_dims[i - 1];
+                    buffer = (T *) allocate(level_bytes);
+                    scope.add_allocations(1);
+                    //std::cout << std::to_string(level_elements[i]) << std::endl;
+
+                    //// extract level i component
+                    interleaver.interleave(data_, dimensions, level_dims[i], prev_dims, reinterpret_cast<T*>(buffer));
+                    //std::cout << std::to_string(level_elements[i]) << std::endl;
+
+                    //// compute max coefficient as level error bound
+                    //std::cout << "there" << std::endl;
+                    T level_max_error = compute_max_abs_value(reinterpret_cast<T*>(buffer), level_elements[i]);
+                    // std::cout << std::to_string(level_elements[i]) << std::endl;
+                    level_error_bounds.push_back(level_max_error);
+                    scope.set_bytes_out(level_bytes);
+                }
                 
                 //// collect errors
                 // auto collected_error = s_collector.collect_level_error(buffer, level_elements[i], num_bitplanes, level_max_error);
                 // level_squared_errors.push_back(collected_error);
                 
 		//// encode level data
-                timer.start();
-                int level_exp = 0;
-                frexp(level_max_error, &level_exp);
-                std::vector<uint32_t> stream_sizes;
-                std::vector<double> level_sq_err;
-                auto streams = encoder.encode(buffer, level_elements[i], level_exp, num_bitplanes, stream_sizes, level_sq_err);
-                free(buffer);
-                level_squared_errors.push_back(level_sq_err);
-                timer.end();
-                //timer.print("Encoding");
+                std::vector<uint64_t> stream_sizes;
+                std::vector<uint8_t*> streams;
+                {
+                    ProfileScope scope("encode", i, level_bytes);
+                    int level_exp = 0;
+                    frexp(level_error_bounds[i], &level_exp);
+                    std::vector<double> level_sq_err;
+                    if(collector.approximate()){
+                        // skip the per-bitplane error collection of the encoder
+                        streams = encoder.encode(buffer, level_elements[i], level_exp, num_bitplanes, stream_sizes);
+                        level_sq_err = collector.collect_level_error(buffer, level_elements[i], num_bitplanes, level_error_bounds[i]);
+                    }
+                    else{
+                        streams = encoder.encode(buffer, level_elements[i], level_exp, num_bitplanes, stream_sizes, level_sq_err);
+                    }
+                    deallocate(buffer);
+                    level_squared_errors.push_back(level_sq_err);
+                    scope.set_bytes_out(std::accumulate(stream_sizes.begin(), stream_sizes.end(), (uint64_t) 0));
+                    scope.add_allocations(streams.size());
+                }
 
                 //// lossless compression
-                timer.start();
-                uint8_t stopping_index = compressor.compress_level(streams, stream_sizes);
-                stopping_indices.push_back(stopping_index);
+                {
+                    ProfileScope scope("compress", i, std::accumulate(stream_sizes.begin(), stream_sizes.end(), (uint64_t) 0));
+                    auto compressed_flags = compressor.compress_level(streams, stream_sizes);
+                    level_compressed_flags.push_back(compressed_flags);
+                    scope.set_bytes_out(std::accumulate(stream_sizes.begin(), stream_sizes.end(), (uint64_t) 0));
+                    scope.add_allocations(std::accumulate(compressed_flags.begin(), compressed_flags.end(), (uint64_t) 0));
+                }
 
                 //// record encoded level data and size
-                level_components.push_back(streams);
+                if(writer.streaming()){
+                    // flush the level right away so that only one level is held in memory
+                    ProfileScope scope("write", i, std::accumulate(stream_sizes.begin(), stream_sizes.end(), (uint64_t) 0));
+                    level_num.push_back(writer.write_level_component(i, streams, stream_sizes));
+                    for(int j=0; j<streams.size(); j++){
+                        deallocate(streams[j]);
+                    }
+                    release_level(i);
+                }
+                else{
+                    level_components.push_back(streams);
+                }
                 level_sizes.push_back(stream_sizes);
-                timer.end();
-                //timer.print("Lossless time");
             }
             //print_vec("level sizes", level_sizes);
+            if(build_rd_index){
+                ProfileScope scope("rate_distortion_index");
+                rd_index = build_rd_index(level_error_bounds, level_squared_errors, level_sizes);
+            }
             return true;
         }
 
@@ -162,11 +238,13 @@ namespace MDR {
         std::vector<T> data;
         std::vector<uint32_t> dimensions;
         std::vector<T> level_error_bounds;
-        std::vector<uint8_t> stopping_indices;
+        std::vector<std::vector<uint8_t>> level_compressed_flags;
         std::vector<std::vector<uint8_t*>> level_components;
-        std::vector<std::vector<uint32_t>> level_sizes;
+        std::vector<std::vector<uint64_t>> level_sizes;
         std::vector<uint32_t> level_num;
         std::vector<std::vector<double>> level_squared_errors;
+        std::function<RateDistortionIndex(const std::vector<T>&, const std::vector<std::vector<double>>&, const std::vector<std::vector<uint64_t>>&)> build_rd_index;
+        RateDistortionIndex rd_index;
     };
 }
 #endif
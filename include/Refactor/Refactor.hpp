@@ -2,5 +2,7 @@
 #define _MDR_REFACTOR_HPP
 
 #include "ComposedRefactor.hpp"
+#include "BatchRefactor.hpp"
+#include "TiledRefactor.hpp"
 
 #endif
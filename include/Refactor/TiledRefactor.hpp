@@ -0,0 +1,116 @@
+#ifndef _MDR_TILED_REFACTOR_HPP
+#define _MDR_TILED_REFACTOR_HPP
+
+#include "ComposedRefactor.hpp"
+#include "Writer/BatchContainerWriter.hpp"
+#include "ThreadPool.hpp"
+#include "Allocator/Allocator.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace MDR {
+    // Out-of-core refactor: the domain is split into tiles, each decomposed with its own hierarchy
+    // tiles are extracted and refactored in a streaming fashion on a thread pool, so at most num_threads tiles are resident
+    // tiles and a tiling record go into one batch container (see TiledReconstructor)
+    template<class T, class Decomposer, class Interleaver, class Encoder, class Compressor, class ErrorCollector>
+    class TiledRefactor {
+    public:
+        TiledRefactor(Decomposer decomposer, Interleaver interleaver, Encoder encoder, Compressor compressor, ErrorCollector collector, const std::string& container_file, int num_threads = std::thread::hardware_concurrency())
+            : decomposer(decomposer), interleaver(interleaver), encoder(encoder), compressor(compressor), collector(collector), container_file(container_file), num_threads(num_threads) {}
+
+        // refactor an array in memory (or mapped by the caller)
+        // returns false, before anything is written, if some tile is too small to be decomposed to target_level
+        bool refactor(T const * data, const std::vector<uint32_t>& dims, const std::vector<uint32_t>& tile_dims, uint8_t target_level, uint8_t num_bitplanes){
+            std::vector<std::vector<uint32_t>> tile_offsets;
+            std::vector<std::vector<uint32_t>> tile_sizes;
+            if(!compute_tiles(dims, tile_dims, tile_offsets, tile_sizes)){
+                std::cerr << "Invalid tile dimensions for a " << dims.size() << "-dimensional array" << std::endl;
+                return false;
+            }
+            // same limit as ComposedRefactor: every tile extent needs at least 2^(target_level + 1) elements
+            const uint64_t min_extent = (uint64_t) 1 << (target_level + 1);
+            for(const auto& tile_size:tile_sizes){
+                for(const auto& d:tile_size){
+                    if(d < min_extent){
+                        std::cerr << "Tile extent " << d << " is too small for target level " << +target_level << ", at least " << min_extent << " is needed" << std::endl;
+                        return false;
+                    }
+                }
+            }
+            auto container = std::make_shared<BatchContainerFile>(container_file);
+            write_tiling(container, dims, tile_offsets, tile_sizes);
+            typedef ComposedRefactor<T, Decomposer, Interleaver, Encoder, Compressor, ErrorCollector, BatchVariableWriter> Refactor;
+            std::vector<std::future<void>> tasks;
+            {
+                ThreadPool pool(num_threads);
+                for(int i=0; i<tile_offsets.size(); i++){
+                    // register tiles in order
+                    BatchVariableWriter writer(container, tile_name(i));
+                    const std::vector<uint32_t>& tile_offset = tile_offsets[i];
+                    const std::vector<uint32_t>& tile_size = tile_sizes[i];
+                    tasks.push_back(pool.submit([this, data, &dims, &tile_offset, &tile_size, writer, target_level, num_bitplanes](){
+                        size_t num_elements = 1;
+                        for(const auto& d:tile_size) num_elements *= d;
+                        std::vector<T> tile(num_elements);
+                        extract_tile(data, dims, tile_offset, tile_size, tile.data());
+                        Refactor refactor(decomposer, interleaver, encoder, compressor, collector, writer);
+                        refactor.refactor(std::move(tile), tile_size, target_level, num_bitplanes);
+                    }));
+                }
+                for(auto& t:tasks) t.get();
+            }
+            container->finalize();
+            return true;
+        }
+
+        // refactor a raw binary file, mapped read-only so that only the tiles being processed occupy private memory
+        bool refactor(const std::string& input_file, const std::vector<uint32_t>& dims, const std::vector<uint32_t>& tile_dims, uint8_t target_level, uint8_t num_bitplanes){
+            size_t num_bytes = sizeof(T);
+            for(const auto& d:dims) num_bytes *= d;
+            int fd = open(input_file.c_str(), O_RDONLY);
+            struct stat st;
+            if((fd < 0) || fstat(fd, &st) || (st.st_size < num_bytes)){
+                std::cerr << "Errors in opening input " << input_file << std::endl;
+                if(fd >= 0) close(fd);
+                return false;
+            }
+            void * mapped = mmap(NULL, num_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if(mapped == MAP_FAILED){
+                std::cerr << "Errors in mmap while reading " << input_file << std::endl;
+                return false;
+            }
+            bool success = refactor(reinterpret_cast<T const *>(mapped), dims, tile_dims, target_level, num_bitplanes);
+            munmap(mapped, num_bytes);
+            return success;
+        }
+
+        void print() const {
+            std::cout << "Tiled refactor with " << num_threads << " threads." << std::endl;
+        }
+    private:
+        // tiling record: number of dimensions, dimensions, number of tiles, then offset and size of each tile
+        void write_tiling(std::shared_ptr<BatchContainerFile> container, const std::vector<uint32_t>& dims, const std::vector<std::vector<uint32_t>>& tile_offsets, const std::vector<std::vector<uint32_t>>& tile_sizes) const {
+            uint64_t size = sizeof(uint8_t) + get_size(dims) + sizeof(uint32_t) + get_size(tile_offsets) + get_size(tile_sizes);
+            uint8_t * tiling = (uint8_t *) allocate(size);
+            uint8_t * tiling_pos = tiling;
+            *(tiling_pos ++) = (uint8_t) dims.size();
+            serialize(dims, tiling_pos);
+            *reinterpret_cast<uint32_t*>(tiling_pos) = tile_offsets.size();
+            tiling_pos += sizeof(uint32_t);
+            serialize(tile_offsets, tiling_pos);
+            serialize(tile_sizes, tiling_pos);
+            BatchVariableWriter(container, MDR_TILING_RECORD).write_metadata(tiling, size);
+            deallocate(tiling);
+        }
+
+        Decomposer decomposer;
+        Interleaver interleaver;
+        Encoder encoder;
+        Compressor compressor;
+        ErrorCollector collector;
+        std::string container_file;
+        int num_threads;
+    };
+}
+#endif
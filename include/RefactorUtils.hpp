@@ -5,6 +5,11 @@
 #include <vector>
 #include <cmath>
 #include <ctime>
+#include <cstring>
+#include <algorithm>
+#include <climits>
+#include <sys/uio.h>
+#include <unistd.h>
 
 namespace MDR {
 
@@ -18,7 +23,7 @@ namespace MDR {
         @params dims: input dimensions
         @params target_level: the target decomposition level
     */
-    std::vector<std::vector<uint32_t>> compute_level_dims(const std::vector<uint32_t>& dims, uint32_t target_level){
+    inline std::vector<std::vector<uint32_t>> compute_level_dims(const std::vector<uint32_t>& dims, uint32_t target_level){
         std::vector<std::vector<uint32_t>> level_dims;
         for(int i=0; i<=target_level; i++){
             level_dims.push_back(std::vector<uint32_t>(dims.size()));
@@ -38,17 +43,17 @@ namespace MDR {
         @params level_dims: dimensions for all levels
         @params target_level: the target decomposition level
     */
-    std::vector<uint32_t> compute_level_elements(const std::vector<std::vector<uint32_t>>& level_dims, int target_level){
+    inline std::vector<uint64_t> compute_level_elements(const std::vector<std::vector<uint32_t>>& level_dims, int target_level){
         assert(level_dims.size());
         uint8_t num_dims = level_dims[0].size();
-        std::vector<uint32_t> level_elements(level_dims.size());
+        std::vector<uint64_t> level_elements(level_dims.size());
         level_elements[0] = 1;
         for(int j=0; j<num_dims; j++){
             level_elements[0] *= level_dims[0][j];
         }
-        uint32_t pre_num_elements = level_elements[0];
+        uint64_t pre_num_elements = level_elements[0];
         for(int i=1; i<=target_level; i++){
-            uint32_t num_elements = 1;
+            uint64_t num_elements = 1;
             for(int j=0; j<num_dims; j++){
                 num_elements *= level_dims[i][j];
             }
@@ -58,6 +63,100 @@ namespace MDR {
         return level_elements;
     }
 
+    // Tiling for out-of-core refactoring
+
+    // split dims into tiles of tile_dims (row-major, dims[0] slowest)
+    // a remainder smaller than half a tile is merged into the last tile so that every tile can be decomposed
+    // returns false if tile_dims does not match the rank of dims or has a zero extent
+    /*
+        @params dims: global dimensions
+        @params tile_dims: nominal tile dimensions
+        @params tile_offsets: output, starting index of each tile
+        @params tile_sizes: output, dimensions of each tile
+    */
+    inline bool compute_tiles(const std::vector<uint32_t>& dims, const std::vector<uint32_t>& tile_dims, std::vector<std::vector<uint32_t>>& tile_offsets, std::vector<std::vector<uint32_t>>& tile_sizes){
+        tile_offsets.clear();
+        tile_sizes.clear();
+        if(dims.empty() || (tile_dims.size() != dims.size())) return false;
+        for(int d=0; d<dims.size(); d++){
+            if((dims[d] == 0) || (tile_dims[d] == 0)) return false;
+        }
+        std::vector<std::vector<uint32_t>> starts(dims.size());
+        std::vector<std::vector<uint32_t>> extents(dims.size());
+        for(int d=0; d<dims.size(); d++){
+            uint32_t start = 0;
+            while(start < dims[d]){
+                uint32_t extent = std::min(tile_dims[d], dims[d] - start);
+                uint32_t rest = dims[d] - start - extent;
+                if((rest > 0) && (rest < tile_dims[d] / 2)) extent += rest;
+                starts[d].push_back(start);
+                extents[d].push_back(extent);
+                start += extent;
+            }
+        }
+        std::vector<int> tile_index(dims.size(), 0);
+        while(true){
+            std::vector<uint32_t> offset(dims.size());
+            std::vector<uint32_t> size(dims.size());
+            for(int d=0; d<dims.size(); d++){
+                offset[d] = starts[d][tile_index[d]];
+                size[d] = extents[d][tile_index[d]];
+            }
+            tile_offsets.push_back(offset);
+            tile_sizes.push_back(size);
+            int d = dims.size() - 1;
+            while((d >= 0) && (++ tile_index[d] == starts[d].size())){
+                tile_index[d] = 0;
+                d --;
+            }
+            if(d < 0) break;
+        }
+        return true;
+    }
+
+    // names of the tiles and of the tiling record in a tiled batch container
+    #define MDR_TILING_RECORD "tiling"
+    inline std::string tile_name(int i){
+        return "tile_" + std::to_string(i);
+    }
+
+    // visit the rows (along the fastest dimension) of a tile: f(global offset, tile offset, row size)
+    template <class Func>
+    void for_each_tile_row(const std::vector<uint32_t>& dims, const std::vector<uint32_t>& tile_offset, const std::vector<uint32_t>& tile_size, Func f){
+        const int num_dims = dims.size();
+        const uint32_t row_size = tile_size[num_dims - 1];
+        size_t num_rows = 1;
+        for(int d=0; d<num_dims-1; d++) num_rows *= tile_size[d];
+        std::vector<uint32_t> row_index(num_dims, 0);
+        for(size_t r=0; r<num_rows; r++){
+            size_t global_offset = 0;
+            for(int d=0; d<num_dims; d++){
+                global_offset = global_offset * dims[d] + tile_offset[d] + row_index[d];
+            }
+            f(global_offset, r * row_size, row_size);
+            for(int d=num_dims-2; d>=0; d--){
+                if(++ row_index[d] < tile_size[d]) break;
+                row_index[d] = 0;
+            }
+        }
+    }
+
+    // copy a tile of the global array into a contiguous buffer
+    template <class T>
+    void extract_tile(T const * global, const std::vector<uint32_t>& dims, const std::vector<uint32_t>& tile_offset, const std::vector<uint32_t>& tile_size, T * tile){
+        for_each_tile_row(dims, tile_offset, tile_size, [global, tile](size_t global_offset, size_t tile_pos, uint32_t row_size){
+            memcpy(tile + tile_pos, global + global_offset, row_size * sizeof(T));
+        });
+    }
+
+    // copy a contiguous tile back into the global array
+    template <class T>
+    void insert_tile(T const * tile, const std::vector<uint32_t>& dims, const std::vector<uint32_t>& tile_offset, const std::vector<uint32_t>& tile_size, T * global){
+        for_each_tile_row(dims, tile_offset, tile_size, [global, tile](size_t global_offset, size_t tile_pos, uint32_t row_size){
+            memcpy(global + global_offset, tile + tile_pos, row_size * sizeof(T));
+        });
+    }
+
     // Simple utility functions
 
     // compute maximum value in level
@@ -66,9 +165,9 @@ namespace MDR {
     @params n: number of level data points
     */
     template <class T>
-    T compute_max_abs_value(const T * data, uint32_t n){
+    T compute_max_abs_value(const T * data, size_t n){
         T max_val = 0;
-        for(int i=0; i<n; i++){
+        for(size_t i=0; i<n; i++){
             T val = fabs(data[i]);
             if(val > max_val) max_val = val;
         }
@@ -77,12 +176,12 @@ namespace MDR {
 
     // Get size of vector
     template <class T>
-    inline uint32_t get_size(const std::vector<T>& vec){
+    inline uint64_t get_size(const std::vector<T>& vec){
         return vec.size() * sizeof(T);
     }
     template <class T>
-    uint32_t get_size(const std::vector<std::vector<T>>& vec){
-        uint32_t size = 0;
+    uint64_t get_size(const std::vector<std::vector<T>>& vec){
+        uint64_t size = 0;
         for(int i=0; i<vec.size(); i++){
             size += sizeof(uint32_t) + vec[i].size() * sizeof(T);
         }
@@ -142,13 +241,117 @@ namespace MDR {
         std::cout << std::endl;
     }
 
+    // Metadata format: version 4 starts with the magic number and version, followed by
+    // dimensions, level error bounds, level squared errors, level sizes (uint64_t), compressed flags, level_num
+    // and an optional rate-distortion index (flag byte, then the serialized index)
+    // version 3 does not record the error estimator in the rate-distortion index
+    // version 2 has no rate-distortion index
+    // version 1 (no header) records uint32_t level sizes and one stopping index per level
+    #define MDR_METADATA_MAGIC 0x4d52444d
+    #define MDR_METADATA_VERSION 4
+    inline void write_metadata_header(uint8_t *& buffer_pos){
+        *reinterpret_cast<uint32_t*>(buffer_pos) = MDR_METADATA_MAGIC;
+        buffer_pos += sizeof(uint32_t);
+        *(buffer_pos ++) = MDR_METADATA_VERSION;
+    }
+    // return the metadata version and skip the header; the first byte of version 1 metadata is the number of dimensions
+    inline uint8_t read_metadata_header(uint8_t const *& buffer_pos){
+        if(*reinterpret_cast<const uint32_t*>(buffer_pos) != MDR_METADATA_MAGIC) return 1;
+        buffer_pos += sizeof(uint32_t);
+        return *(buffer_pos ++);
+    }
+
+    // Single-file container layout
+    // [level 0 bitplanes][pad][level 1 bitplanes][pad]...[metadata][index][trailer]
+    // each level starts at a multiple of the alignment (filesystem stripe size)
+    // index: for each level, number of bitplanes (uint32_t) followed by (offset, size) of each bitplane (uint64_t)
+    #define MDR_CONTAINER_MAGIC 0x4d445243
+    struct ContainerTrailer{
+        uint64_t metadata_offset;
+        uint64_t metadata_size;
+        uint64_t index_offset;
+        uint64_t index_size;
+        uint32_t num_levels;
+        uint32_t magic;
+    };
+
+    // Batch container layout (many variables in one file)
+    // [variable 0 levels][variable 0 metadata]...[variable index][trailer]
+    // regions start at a multiple of the alignment and may be interleaved between variables
+    // variable index: for each variable, name length (uint32_t), name, metadata offset and size (uint64_t),
+    // number of levels (uint32_t), followed by the level index of the single-file container
+    #define MDR_BATCH_CONTAINER_MAGIC 0x4d444242
+    struct BatchContainerTrailer{
+        uint64_t index_offset;
+        uint64_t index_size;
+        uint32_t num_variables;
+        uint32_t magic;
+    };
+
+    // HPSS segmented layout
+    // each level is cut into segments of segment_size bytes (the last one may be shorter)
+    // segment k of level i is stored in file level_files[i] + "_" + k
+    // metadata file: [metadata][level size of each level (uint64_t)][trailer]
+    #define MDR_HPSS_SEGMENT_MAGIC 0x4d445348
+    struct HPSSSegmentTrailer{
+        uint64_t metadata_size;
+        uint64_t segment_size;
+        uint32_t num_levels;
+        uint32_t magic;
+    };
+
+    inline std::string segment_name(const std::string& level_file, uint64_t k){
+        return level_file + "_" + std::to_string(k);
+    }
+
+    // Reorganized single-stream layout
+    // data file: the bitplanes of all levels back to back in the order chosen by a reorganizer,
+    // the bitplanes of each level in increasing order
+    // metadata file: [metadata][order table: level of each bitplane in data file order (uint8_t)][trailer]
+    #define MDR_REORGANIZED_MAGIC 0x4d44524f
+    struct ReorganizedTrailer{
+        uint64_t metadata_size;
+        uint32_t num_bitplanes;
+        uint32_t magic;
+    };
+
+    // write the buffers back to back from offset with vectored I/O, at most IOV_MAX buffers per call
+    // returns false if the write fails
+    inline bool pwritev_all(int fd, const std::vector<uint8_t*>& buffers, const std::vector<uint64_t>& sizes, uint64_t offset){
+        std::vector<struct iovec> iov;
+        for(int i=0; i<buffers.size(); i++){
+            if(sizes[i] == 0) continue;
+            struct iovec v;
+            v.iov_base = buffers[i];
+            v.iov_len = sizes[i];
+            iov.push_back(v);
+        }
+        size_t begin = 0;
+        while(begin < iov.size()){
+            int count = std::min(iov.size() - begin, (size_t) IOV_MAX);
+            ssize_t written = pwritev(fd, &iov[begin], count, offset);
+            if(written <= 0) return false;
+            offset += written;
+            // skip the buffers written completely and resume a partial one
+            while((begin < iov.size()) && ((size_t) written >= iov[begin].iov_len)){
+                written -= iov[begin].iov_len;
+                begin ++;
+            }
+            if(written > 0){
+                iov[begin].iov_base = reinterpret_cast<uint8_t*>(iov[begin].iov_base) + written;
+                iov[begin].iov_len -= written;
+            }
+        }
+        return true;
+    }
+
     class Timer{
     public:
         void start(){
-            err = clock_gettime(CLOCK_REALTIME, &start_time);
+            err = clock_gettime(CLOCK_MONOTONIC, &start_time);
         }
         void end(){
-            err = clock_gettime(CLOCK_REALTIME, &end_time);
+            err = clock_gettime(CLOCK_MONOTONIC, &end_time);
             total_time += (double)(end_time.tv_sec - start_time.tv_sec) + (double)(end_time.tv_nsec - start_time.tv_nsec)/(double)1000000000;
         }
         double get(){
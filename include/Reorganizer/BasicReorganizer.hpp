@@ -2,13 +2,14 @@
 #define _MDR_BASIC_REORGANIZER_HPP
 
 #include "ReorganizerInterface.hpp"
+#include "Allocator/Allocator.hpp"
 
 namespace MDR {
     // direct in-order bit-plane placement
     class InOrderReorganizer : public concepts::ReorganizerInterface {
     public:
         InOrderReorganizer(){}
-        uint8_t * reorganize(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint32_t>>& level_sizes, std::vector<uint8_t>& order, uint32_t& total_size) const {
+        uint8_t * reorganize(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint64_t>>& level_sizes, std::vector<uint8_t>& order, uint64_t& total_size) const {
             const int num_levels = level_sizes.size();
             total_size = 0;
             for(int i=0; i<num_levels; i++){
@@ -16,7 +17,7 @@ namespace MDR {
                     total_size += level_sizes[i][j];
                 }
             }
-            uint8_t * reorganized_data = (uint8_t *) malloc(total_size);
+            uint8_t * reorganized_data = (uint8_t *) allocate(total_size);
             uint8_t * reorganized_data_pos = reorganized_data;
             for(int i=0; i<num_levels; i++){
                 for(int j=0; j<level_sizes[i].size(); j++){
@@ -35,7 +36,7 @@ namespace MDR {
     class RoundRobinReorganizer : public concepts::ReorganizerInterface {
     public:
         RoundRobinReorganizer(){}
-        uint8_t * reorganize(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint32_t>>& level_sizes, std::vector<uint8_t>& order, uint32_t& total_size) const {
+        uint8_t * reorganize(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint64_t>>& level_sizes, std::vector<uint8_t>& order, uint64_t& total_size) const {
             const int num_levels = level_sizes.size();
             total_size = 0;
             for(int i=0; i<num_levels; i++){
@@ -43,7 +44,7 @@ namespace MDR {
                     total_size += level_sizes[i][j];
                 }
             }
-            uint8_t * reorganized_data = (uint8_t *) malloc(total_size);
+            uint8_t * reorganized_data = (uint8_t *) allocate(total_size);
             uint8_t * reorganized_data_pos = reorganized_data;
             int max_level_size = 0;
             for(int i=0; i<num_levels; i++){
@@ -51,9 +52,9 @@ namespace MDR {
                     max_level_size = level_sizes[i].size();
                 }
             }
-            for(int j=0; j<max_level_size - 1; j++){
+            for(int j=0; j<max_level_size; j++){
                 for(int i=0; i<num_levels; i++){
-                    if(j >= level_sizes[i].size() - 1) continue;
+                    if(j >= level_sizes[i].size()) continue;
                     order.push_back(i);
                     memcpy(reorganized_data_pos, level_components[i][j], level_sizes[i][j]);
                     reorganized_data_pos += level_sizes[i][j];
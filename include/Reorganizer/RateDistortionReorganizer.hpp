@@ -0,0 +1,66 @@
+#ifndef _MDR_RATE_DISTORTION_REORGANIZER_HPP
+#define _MDR_RATE_DISTORTION_REORGANIZER_HPP
+
+#include "ReorganizerInterface.hpp"
+#include "SizeInterpreter/RateDistortionIndex.hpp"
+#include "Allocator/Allocator.hpp"
+#include <cstring>
+
+namespace MDR {
+    // Rate-distortion ordered bit-plane placement: bitplanes are laid out in the greedy retrieval order
+    // of the rate-distortion index, so retrieving to any tolerance along that order reads a prefix of the data
+    // the index is built by the refactor (set_rate_distortion_estimator); without one, bitplanes are placed in order
+    class RateDistortionReorganizer : public concepts::ReorganizerInterface {
+    public:
+        RateDistortionReorganizer(){}
+        uint8_t * reorganize(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint64_t>>& level_sizes, std::vector<uint8_t>& order, uint64_t& total_size) const {
+            const int num_levels = level_sizes.size();
+            total_size = 0;
+            for(int i=0; i<num_levels; i++){
+                for(int j=0; j<level_sizes[i].size(); j++){
+                    total_size += level_sizes[i][j];
+                }
+            }
+            std::vector<uint8_t> placement = rd_order;
+            if(!covers(placement, level_sizes)){
+                std::cerr << "RateDistortionReorganizer: no rate-distortion index for these levels, bitplanes are placed in order" << std::endl;
+                placement.clear();
+                for(int i=0; i<num_levels; i++){
+                    placement.insert(placement.end(), level_sizes[i].size(), (uint8_t) i);
+                }
+            }
+            uint8_t * reorganized_data = (uint8_t *) allocate(total_size);
+            uint8_t * reorganized_data_pos = reorganized_data;
+            std::vector<uint32_t> index(num_levels, 0);
+            for(const auto& i:placement){
+                int j = index[i] ++;
+                order.push_back(i);
+                memcpy(reorganized_data_pos, level_components[i][j], level_sizes[i][j]);
+                reorganized_data_pos += level_sizes[i][j];
+            }
+            return reorganized_data;
+        }
+        void load_rate_distortion_index(const RateDistortionIndex& rd_index){
+            rd_order = rd_index.order;
+        }
+        void print() const {
+            std::cout << "Rate-distortion reorganizer." << std::endl;
+        }
+    private:
+        // the order must take every bitplane of every level exactly once
+        static bool covers(const std::vector<uint8_t>& order, const std::vector<std::vector<uint64_t>>& level_sizes){
+            std::vector<uint32_t> counts(level_sizes.size(), 0);
+            for(const auto& i:order){
+                if(i >= level_sizes.size()) return false;
+                counts[i] ++;
+            }
+            for(int i=0; i<level_sizes.size(); i++){
+                if(counts[i] != level_sizes[i].size()) return false;
+            }
+            return true;
+        }
+
+        std::vector<uint8_t> rd_order;
+    };
+}
+#endif
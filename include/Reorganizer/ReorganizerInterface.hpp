@@ -2,6 +2,8 @@
 #define _MDR_REORGANIZER_INTERFACE_HPP
 
 namespace MDR {
+    struct RateDistortionIndex;
+
     namespace concepts {
 
         // level bit-plane reorganizer: EBCOT-like algorithm for multilevel bit-plane truncation
@@ -10,7 +12,10 @@ namespace MDR {
 
             virtual ~ReorganizerInterface() = default;
 
-            virtual uint8_t * reorganize(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint32_t>>& level_sizes, std::vector<uint8_t>& order, uint32_t& total_size) const = 0;
+            virtual uint8_t * reorganize(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint64_t>>& level_sizes, std::vector<uint8_t>& order, uint64_t& total_size) const = 0;
+
+            // precomputed retrieval order of the refactored data; reorganizers that do not use it ignore it
+            virtual void load_rate_distortion_index(const RateDistortionIndex& rd_index) {}
 
             virtual void print() const = 0;
         };
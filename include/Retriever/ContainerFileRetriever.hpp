@@ -0,0 +1,177 @@
+#ifndef _MDR_CONTAINER_FILE_RETRIEVER_HPP
+#define _MDR_CONTAINER_FILE_RETRIEVER_HPP
+
+#include "RetrieverInterface.hpp"
+#include "RefactorUtils.hpp"
+#include "Allocator/Allocator.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace MDR {
+    // Data retriever for the single-file container: at most one read per level
+    // a variable name selects one variable of a batch container
+    class ContainerFileRetriever : public concepts::RetrieverInterface {
+    public:
+        ContainerFileRetriever(const std::string& container_file, const std::string& variable_name = "") : container_file(container_file), variable_name(variable_name) {
+            fd = open(container_file.c_str(), O_RDONLY);
+            if((fd < 0) || !load_index()){
+                std::cerr << "Errors in loading container " << container_file << " " << variable_name << std::endl;
+                exit(-1);
+            }
+        }
+        ContainerFileRetriever(const ContainerFileRetriever& other) : container_file(other.container_file), variable_name(other.variable_name), metadata_offset(other.metadata_offset), metadata_size(other.metadata_size), level_bitplane_offsets(other.level_bitplane_offsets), level_bitplane_sizes(other.level_bitplane_sizes) {
+            fd = dup(other.fd);
+        }
+        ContainerFileRetriever& operator=(const ContainerFileRetriever& other) = delete;
+
+        std::vector<std::vector<const uint8_t*>> retrieve_level_components(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<uint64_t>& retrieve_sizes, const std::vector<uint8_t>& prev_level_num_bitplanes, const std::vector<uint8_t>& level_num_bitplanes){
+            assert(level_bitplane_offsets.size() == retrieve_sizes.size());
+            release();
+            uint64_t total_retrieve_size = 0;
+            std::vector<std::vector<const uint8_t*>> level_components;
+            for(int i=0; i<level_num_bitplanes.size(); i++){
+                std::cout << + level_num_bitplanes[i] << +"," ; // numbers of bitplanes
+                const int begin = prev_level_num_bitplanes[i];
+                const int end = level_num_bitplanes[i];
+                if(end > level_bitplane_sizes[i].size()){
+                    std::cerr << "Errors in retrieving " << end << " bitplanes of level " << i << " from " << container_file << std::endl;
+                    release();
+                    return std::vector<std::vector<const uint8_t*>>();
+                }
+                uint64_t size = 0;
+                for(int j=begin; j<end; j++){
+                    size += level_bitplane_sizes[i][j];
+                }
+                // requested bitplanes are contiguous in the container
+                uint8_t * buffer = (uint8_t *) allocate(size > 0 ? size : 1);
+                concated_level_components.push_back(buffer);
+                if((size > 0) && !read_all(buffer, size, level_bitplane_offsets[i][begin])){
+                    release();
+                    return std::vector<std::vector<const uint8_t*>>();
+                }
+                std::vector<const uint8_t*> interleaved_level;
+                const uint8_t * pos = buffer;
+                for(int j=begin; j<end; j++){
+                    interleaved_level.push_back(pos);
+                    pos += level_bitplane_sizes[i][j];
+                }
+                level_components.push_back(interleaved_level);
+                for(int j=0; j<end; j++){
+                    total_retrieve_size += level_bitplane_sizes[i][j];
+                }
+            }
+            std::cout << "Total_retrieve_size," << total_retrieve_size << ",";
+            return level_components;
+        }
+
+        void prefetch(const std::vector<uint64_t>& retrieve_sizes){}
+
+        uint8_t * load_metadata() const {
+            uint8_t * metadata = (uint8_t *) allocate(metadata_size);
+            if(!read_all(metadata, metadata_size, metadata_offset)){
+                std::cerr << "Errors in loading metadata from " << container_file << std::endl;
+                exit(-1);
+            }
+            return metadata;
+        }
+
+        void release(){
+            for(int i=0; i<concated_level_components.size(); i++){
+                deallocate(concated_level_components[i]);
+            }
+            concated_level_components.clear();
+        }
+
+        ~ContainerFileRetriever(){
+            release();
+            if(fd >= 0) close(fd);
+        }
+
+        void print() const {
+            std::cout << "Container file retriever." << std::endl;
+        }
+    private:
+        bool load_index(){
+            off_t file_size = lseek(fd, 0, SEEK_END);
+            if(file_size < (off_t) sizeof(BatchContainerTrailer)) return false;
+            // both trailers end with the magic number
+            uint32_t magic = 0;
+            if(!read_all(reinterpret_cast<uint8_t*>(&magic), sizeof(uint32_t), file_size - sizeof(uint32_t))) return false;
+            if((magic == MDR_CONTAINER_MAGIC) && variable_name.empty()){
+                if(file_size < (off_t) sizeof(ContainerTrailer)) return false;
+                ContainerTrailer trailer;
+                if(!read_all(reinterpret_cast<uint8_t*>(&trailer), sizeof(ContainerTrailer), file_size - sizeof(ContainerTrailer))) return false;
+                metadata_offset = trailer.metadata_offset;
+                metadata_size = trailer.metadata_size;
+                std::vector<uint8_t> index(trailer.index_size);
+                if(!read_all(index.data(), index.size(), trailer.index_offset)) return false;
+                uint8_t const * index_pos = index.data();
+                load_level_index(index_pos, trailer.num_levels);
+                return true;
+            }
+            if(magic == MDR_BATCH_CONTAINER_MAGIC){
+                BatchContainerTrailer trailer;
+                if(!read_all(reinterpret_cast<uint8_t*>(&trailer), sizeof(BatchContainerTrailer), file_size - sizeof(BatchContainerTrailer))) return false;
+                std::vector<uint8_t> index(trailer.index_size);
+                if(!read_all(index.data(), index.size(), trailer.index_offset)) return false;
+                uint8_t const * index_pos = index.data();
+                for(int i=0; i<trailer.num_variables; i++){
+                    uint32_t name_length = *reinterpret_cast<const uint32_t*>(index_pos);
+                    index_pos += sizeof(uint32_t);
+                    std::string name(reinterpret_cast<const char*>(index_pos), name_length);
+                    index_pos += name_length;
+                    metadata_offset = *reinterpret_cast<const uint64_t*>(index_pos);
+                    metadata_size = *reinterpret_cast<const uint64_t*>(index_pos + sizeof(uint64_t));
+                    index_pos += 2 * sizeof(uint64_t);
+                    uint32_t num_levels = *reinterpret_cast<const uint32_t*>(index_pos);
+                    index_pos += sizeof(uint32_t);
+                    level_bitplane_offsets.clear();
+                    level_bitplane_sizes.clear();
+                    load_level_index(index_pos, num_levels);
+                    if(name == variable_name) return true;
+                }
+            }
+            return false;
+        }
+
+        void load_level_index(uint8_t const *& index_pos, uint32_t num_levels){
+            for(int i=0; i<num_levels; i++){
+                uint32_t num_bitplanes = *reinterpret_cast<const uint32_t*>(index_pos);
+                index_pos += sizeof(uint32_t);
+                std::vector<uint64_t> offsets(num_bitplanes);
+                std::vector<uint64_t> sizes(num_bitplanes);
+                for(int j=0; j<num_bitplanes; j++){
+                    offsets[j] = *reinterpret_cast<const uint64_t*>(index_pos);
+                    sizes[j] = *reinterpret_cast<const uint64_t*>(index_pos + sizeof(uint64_t));
+                    index_pos += 2 * sizeof(uint64_t);
+                }
+                level_bitplane_offsets.push_back(offsets);
+                level_bitplane_sizes.push_back(sizes);
+            }
+        }
+
+        bool read_all(uint8_t * buffer, uint64_t size, uint64_t offset) const {
+            while(size > 0){
+                ssize_t count = pread(fd, buffer, size, offset);
+                if(count <= 0){
+                    std::cerr << "Errors in pread while retrieving from " << container_file << std::endl;
+                    return false;
+                }
+                buffer += count;
+                size -= count;
+                offset += count;
+            }
+            return true;
+        }
+
+        std::string container_file;
+        std::string variable_name;
+        int fd = -1;
+        uint64_t metadata_offset = 0;
+        uint64_t metadata_size = 0;
+        std::vector<std::vector<uint64_t>> level_bitplane_offsets;
+        std::vector<std::vector<uint64_t>> level_bitplane_sizes;
+        std::vector<uint8_t*> concated_level_components;
+    };
+}
+#endif
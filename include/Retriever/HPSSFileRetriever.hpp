@@ -1,63 +1,147 @@
 #ifndef _MDR_HPSS_FILE_RETRIEVER_HPP
-#define _MDR_HOSS_FILE_RETRIEVER_HPP
+#define _MDR_HPSS_FILE_RETRIEVER_HPP
 
 #include "RetrieverInterface.hpp"
+#include "RefactorUtils.hpp"
+#include "ThreadPool.hpp"
+#include "Allocator/Allocator.hpp"
 #include <cstdio>
+#include <memory>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace MDR {
-    // Data retriever for files
-    class ConcatLevelFileRetriever : public concepts::RetrieverInterface {
+    // Data retriever for the segments written by HPSSFileWriter
+    // only the segments overlapping the requested byte ranges are read, concurrently
+    class HPSSFileRetriever : public concepts::RetrieverInterface {
     public:
-        ConcatLevelFileRetriever(const std::string& metadata_file, const std::vector<std::string>& level_files) : metadata_file(metadata_file), level_files(level_files) {
-            offsets = std::vector<uint32_t>(level_files.size(), 0);
+        HPSSFileRetriever(const std::string& metadata_file, const std::vector<std::string>& level_files, int num_threads = 8) : metadata_file(metadata_file), level_files(level_files), pool(std::make_shared<ThreadPool>(num_threads)) {
+            offsets = std::vector<uint64_t>(level_files.size(), 0);
+            if(!load_segment_map()){
+                std::cerr << "Errors in loading segment map from " << metadata_file << std::endl;
+                exit(-1);
+            }
         }
 
-        std::vector<std::vector<const uint8_t*>> retrieve_level_components(const std::vector<std::vector<uint32_t>>& level_sizes, const std::vector<uint32_t>& retrieve_sizes, const std::vector<uint8_t>& prev_level_num_bitplanes, const std::vector<uint8_t>& level_num_bitplanes){
+        std::vector<std::vector<const uint8_t*>> retrieve_level_components(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<uint64_t>& retrieve_sizes, const std::vector<uint8_t>& prev_level_num_bitplanes, const std::vector<uint8_t>& level_num_bitplanes){
             assert(offsets.size() == retrieve_sizes.size());
             release();
-            uint32_t total_retrieve_size = 0;
+            uint64_t total_retrieve_size = 0;
+            std::vector<std::future<bool>> tasks;
+            bool success = true;
             for(int i=0; i<level_files.size(); i++){
-                std::cout << "Retrieve " << +level_num_bitplanes[i] << " (" << +(level_num_bitplanes[i] - prev_level_num_bitplanes[i]) << " more) bitplanes from level " << i << std::endl;
-                FILE * file = fopen(level_files[i].c_str(), "r");
-                if(fseek(file, offsets[i], SEEK_SET)){
-                    std::cerr << "Errors in fseek while retrieving from file" << std::endl;
-                }
-                uint8_t * buffer = (uint8_t *) malloc(retrieve_sizes[i]);
-                fread(buffer, sizeof(uint8_t), retrieve_sizes[i], file);
+                std::cout << + level_num_bitplanes[i] << +"," ; // numbers of bitplanes
+                uint8_t * buffer = (uint8_t *) allocate(retrieve_sizes[i] > 0 ? retrieve_sizes[i] : 1);
                 concated_level_components.push_back(buffer);
-                fclose(file);
+                // one read per segment overlapping [offset, offset + retrieve_size)
+                uint64_t begin = offsets[i];
+                uint64_t end = offsets[i] + retrieve_sizes[i];
+                if(end > level_byte_sizes[i]){
+                    std::cerr << "Errors in retrieving " << retrieve_sizes[i] << " bytes at offset " << offsets[i] << " from level " << i << " of " << level_byte_sizes[i] << " bytes" << std::endl;
+                    success = false;
+                    break;
+                }
+                while(begin < end){
+                    uint64_t k = begin / segment_size;
+                    uint64_t segment_end = std::min((k + 1) * segment_size, end);
+                    std::string filename = segment_name(level_files[i], k);
+                    uint8_t * dst = buffer + (begin - offsets[i]);
+                    uint64_t size = segment_end - begin;
+                    uint64_t segment_offset = begin - k * segment_size;
+                    tasks.push_back(pool->submit([filename, dst, size, segment_offset](){
+                        return read_segment(filename, dst, size, segment_offset);
+                    }));
+                    begin = segment_end;
+                }
+            }
+            for(auto& t:tasks) success = t.get() && success;
+            if(!success){
+                // offsets are kept so that the request can be repeated
+                release();
+                return std::vector<std::vector<const uint8_t*>>();
+            }
+            for(int i=0; i<level_files.size(); i++){
                 offsets[i] += retrieve_sizes[i];
                 total_retrieve_size += offsets[i];
             }
-            std::cout << "Total retrieve size = " << total_retrieve_size << std::endl;
+            std::cout << "Total_retrieve_size," << total_retrieve_size << ",";
             return interleave_level_components(level_sizes, prev_level_num_bitplanes, level_num_bitplanes);
         }
 
+        void prefetch(const std::vector<uint64_t>& retrieve_sizes){}
+
         uint8_t * load_metadata() const {
             FILE * file = fopen(metadata_file.c_str(), "r");
-            fseek(file, 0, SEEK_END);
-            uint32_t num_bytes = ftell(file);
-            rewind(file);
-            uint8_t * metadata = (uint8_t *) malloc(num_bytes);
-            fread(metadata, 1, num_bytes, file);
+            if(file == NULL){
+                std::cerr << "Errors in loading metadata from " << metadata_file << std::endl;
+                exit(-1);
+            }
+            uint8_t * metadata = (uint8_t *) allocate(metadata_size);
+            if(fread(metadata, 1, metadata_size, file) != metadata_size){
+                std::cerr << "Errors in reading metadata from " << metadata_file << std::endl;
+            }
             fclose(file);
             return metadata;
         }
 
         void release(){
             for(int i=0; i<concated_level_components.size(); i++){
-                free(concated_level_components[i]);
+                deallocate(concated_level_components[i]);
             }
             concated_level_components.clear();
         }
 
-        ~ConcatLevelFileRetriever(){}
+        ~HPSSFileRetriever(){
+            release();
+        }
 
         void print() const {
-            std::cout << "File retriever." << std::endl;
+            std::cout << "HPSS file retriever." << std::endl;
         }
     private:
-        std::vector<std::vector<const uint8_t*>> interleave_level_components(const std::vector<std::vector<uint32_t>>& level_sizes, const std::vector<uint8_t>& prev_level_num_bitplanes, const std::vector<uint8_t>& level_num_bitplanes){
+        bool load_segment_map(){
+            FILE * file = fopen(metadata_file.c_str(), "r");
+            if(file == NULL) return false;
+            fseek(file, 0, SEEK_END);
+            long num_bytes = ftell(file);
+            HPSSSegmentTrailer trailer;
+            bool success = (num_bytes >= (long) sizeof(HPSSSegmentTrailer));
+            if(success){
+                fseek(file, num_bytes - sizeof(HPSSSegmentTrailer), SEEK_SET);
+                success = (fread(&trailer, sizeof(HPSSSegmentTrailer), 1, file) == 1) && (trailer.magic == MDR_HPSS_SEGMENT_MAGIC) && (trailer.num_levels == level_files.size());
+            }
+            if(success){
+                metadata_size = trailer.metadata_size;
+                segment_size = trailer.segment_size;
+                level_byte_sizes = std::vector<uint64_t>(trailer.num_levels);
+                fseek(file, metadata_size, SEEK_SET);
+                success = (fread(level_byte_sizes.data(), sizeof(uint64_t), trailer.num_levels, file) == trailer.num_levels);
+            }
+            fclose(file);
+            return success;
+        }
+
+        static bool read_segment(const std::string& filename, uint8_t * buffer, uint64_t size, uint64_t offset){
+            int fd = open(filename.c_str(), O_RDONLY);
+            if(fd < 0){
+                std::cerr << "Errors in open while retrieving from file " << filename << std::endl;
+                return false;
+            }
+            while(size > 0){
+                ssize_t count = pread(fd, buffer, size, offset);
+                if(count <= 0){
+                    std::cerr << "Errors in pread while retrieving from file " << filename << std::endl;
+                    break;
+                }
+                buffer += count;
+                size -= count;
+                offset += count;
+            }
+            close(fd);
+            return size == 0;
+        }
+
+        std::vector<std::vector<const uint8_t*>> interleave_level_components(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<uint8_t>& prev_level_num_bitplanes, const std::vector<uint8_t>& level_num_bitplanes){
             std::vector<std::vector<const uint8_t*>> level_components;
             for(int i=0; i<level_num_bitplanes.size(); i++){
                 const uint8_t * pos = concated_level_components[i];
@@ -71,9 +155,13 @@ namespace MDR {
             return level_components;
         }
 
-        std::vector<std::string> level_files;
         std::string metadata_file;
-        std::vector<uint32_t> offsets;
+        std::vector<std::string> level_files;
+        std::shared_ptr<ThreadPool> pool;
+        uint64_t metadata_size = 0;
+        uint64_t segment_size = 0;
+        std::vector<uint64_t> level_byte_sizes;
+        std::vector<uint64_t> offsets;
         std::vector<uint8_t*> concated_level_components;
     };
 }
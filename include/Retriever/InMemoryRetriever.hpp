@@ -0,0 +1,69 @@
+#ifndef _MDR_IN_MEMORY_RETRIEVER_HPP
+#define _MDR_IN_MEMORY_RETRIEVER_HPP
+
+#include "RetrieverInterface.hpp"
+#include "InMemoryStore.hpp"
+#include "Allocator/Allocator.hpp"
+#include <memory>
+#include <cstring>
+
+namespace MDR {
+    // Data retriever for an in-memory store: bitplanes are handed out in place, without I/O or copies
+    class InMemoryRetriever : public concepts::RetrieverInterface {
+    public:
+        InMemoryRetriever(std::shared_ptr<InMemoryStore> store) : store(store) {}
+
+        std::vector<std::vector<const uint8_t*>> retrieve_level_components(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<uint64_t>& retrieve_sizes, const std::vector<uint8_t>& prev_level_num_bitplanes, const std::vector<uint8_t>& level_num_bitplanes){
+            std::lock_guard<std::mutex> lock(store->mutex);
+            if((store->levels.size() != retrieve_sizes.size()) || (level_num_bitplanes.size() != retrieve_sizes.size())){
+                std::cerr << "Errors in retrieving " << retrieve_sizes.size() << " levels from a store of " << store->levels.size() << " levels" << std::endl;
+                return std::vector<std::vector<const uint8_t*>>();
+            }
+            if(offsets.empty()) offsets = std::vector<uint64_t>(store->levels.size(), 0);
+            for(int i=0; i<store->levels.size(); i++){
+                if(offsets[i] + retrieve_sizes[i] > store->levels[i].size()){
+                    std::cerr << "Errors in retrieving " << retrieve_sizes[i] << " bytes at offset " << offsets[i] << " from level " << i << " of " << store->levels[i].size() << " bytes" << std::endl;
+                    return std::vector<std::vector<const uint8_t*>>();
+                }
+            }
+            uint64_t total_retrieve_size = 0;
+            std::vector<std::vector<const uint8_t*>> level_components;
+            for(int i=0; i<level_num_bitplanes.size(); i++){
+                std::cout << + level_num_bitplanes[i] << +"," ; // numbers of bitplanes
+                const uint8_t * pos = store->levels[i].data() + offsets[i];
+                std::vector<const uint8_t*> interleaved_level;
+                for(int j=prev_level_num_bitplanes[i]; j<level_num_bitplanes[i]; j++){
+                    interleaved_level.push_back(pos);
+                    pos += level_sizes[i][j];
+                }
+                level_components.push_back(interleaved_level);
+                offsets[i] += retrieve_sizes[i];
+                total_retrieve_size += offsets[i];
+            }
+            std::cout << "Total_retrieve_size," << total_retrieve_size << ",";
+            return level_components;
+        }
+
+        void prefetch(const std::vector<uint64_t>& retrieve_sizes){}
+
+        uint8_t * load_metadata() const {
+            std::lock_guard<std::mutex> lock(store->mutex);
+            uint8_t * metadata = (uint8_t *) allocate(store->metadata.size());
+            memcpy(metadata, store->metadata.data(), store->metadata.size());
+            return metadata;
+        }
+
+        // components are owned by the store
+        void release(){}
+
+        ~InMemoryRetriever(){}
+
+        void print() const {
+            std::cout << "In-memory retriever." << std::endl;
+        }
+    private:
+        std::shared_ptr<InMemoryStore> store;
+        std::vector<uint64_t> offsets;
+    };
+}
+#endif
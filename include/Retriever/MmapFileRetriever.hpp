@@ -0,0 +1,138 @@
+#ifndef _MDR_MMAP_FILE_RETRIEVER_HPP
+#define _MDR_MMAP_FILE_RETRIEVER_HPP
+
+#include "RetrieverInterface.hpp"
+#include "Allocator/Allocator.hpp"
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace MDR {
+    // Zero-copy data retriever for concatenated level files
+    // Each level file is mapped once; retrieved components are views into the mapping
+    class MmapLevelFileRetriever : public concepts::RetrieverInterface {
+    public:
+        MmapLevelFileRetriever(const std::string& metadata_file, const std::vector<std::string>& level_files) : metadata_file(metadata_file), level_files(level_files) {
+            offsets = std::vector<uint64_t>(level_files.size(), 0);
+            mapped_levels = std::vector<uint8_t*>(level_files.size(), NULL);
+            mapped_sizes = std::vector<size_t>(level_files.size(), 0);
+        }
+        // mappings are not shared: a copy maps the files again on first retrieval
+        MmapLevelFileRetriever(const MmapLevelFileRetriever& other) : MmapLevelFileRetriever(other.metadata_file, other.level_files) {
+            offsets = other.offsets;
+        }
+        MmapLevelFileRetriever& operator=(const MmapLevelFileRetriever& other) = delete;
+
+        std::vector<std::vector<const uint8_t*>> retrieve_level_components(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<uint64_t>& retrieve_sizes, const std::vector<uint8_t>& prev_level_num_bitplanes, const std::vector<uint8_t>& level_num_bitplanes){
+            assert(offsets.size() == retrieve_sizes.size());
+            const size_t page_size = sysconf(_SC_PAGESIZE);
+            // check every level before handing out views, so that a failed request keeps the offsets
+            for(int i=0; i<level_files.size(); i++){
+                if(!retrieve_sizes[i]) continue;
+                if(!map_level(i)){
+                    std::cerr << "Errors in mmap while retrieving from file " << level_files[i] << std::endl;
+                    return std::vector<std::vector<const uint8_t*>>();
+                }
+                if(offsets[i] + retrieve_sizes[i] > mapped_sizes[i]){
+                    std::cerr << "Errors in retrieving " << retrieve_sizes[i] << " bytes at offset " << offsets[i] << " from file " << level_files[i] << " of " << mapped_sizes[i] << " bytes" << std::endl;
+                    return std::vector<std::vector<const uint8_t*>>();
+                }
+            }
+            uint64_t total_retrieve_size = 0;
+            std::vector<std::vector<const uint8_t*>> level_components;
+            for(int i=0; i<level_files.size(); i++){
+                std::cout << + level_num_bitplanes[i] << +"," ; // numbers of bitplanes
+                std::vector<const uint8_t*> interleaved_level;
+                if(retrieve_sizes[i]){
+                    // prefetch exactly the requested range (aligned to page boundary)
+                    size_t aligned_offset = offsets[i] / page_size * page_size;
+                    madvise(mapped_levels[i] + aligned_offset, offsets[i] + retrieve_sizes[i] - aligned_offset, MADV_WILLNEED);
+                    const uint8_t * pos = mapped_levels[i] + offsets[i];
+                    for(int j=prev_level_num_bitplanes[i]; j<level_num_bitplanes[i]; j++){
+                        interleaved_level.push_back(pos);
+                        pos += level_sizes[i][j];
+                    }
+                }
+                level_components.push_back(interleaved_level);
+                offsets[i] += retrieve_sizes[i];
+                total_retrieve_size += offsets[i];
+            }
+            std::cout << "Total_retrieve_size," << total_retrieve_size << ",";
+            return level_components;
+        }
+
+        void prefetch(const std::vector<uint64_t>& retrieve_sizes){
+            assert(offsets.size() == retrieve_sizes.size());
+            const size_t page_size = sysconf(_SC_PAGESIZE);
+            for(int i=0; i<level_files.size(); i++){
+                if(!retrieve_sizes[i] || !map_level(i)) continue;
+                // a mispredicted range past the end of the file is not advised
+                if(offsets[i] + retrieve_sizes[i] > mapped_sizes[i]) continue;
+                size_t aligned_offset = offsets[i] / page_size * page_size;
+                madvise(mapped_levels[i] + aligned_offset, offsets[i] + retrieve_sizes[i] - aligned_offset, MADV_WILLNEED);
+            }
+        }
+
+        uint8_t * load_metadata() const {
+            int fd = open(metadata_file.c_str(), O_RDONLY);
+            struct stat st;
+            if((fd < 0) || fstat(fd, &st) || (st.st_size == 0)){
+                std::cerr << "Errors in loading metadata from " << metadata_file << std::endl;
+                exit(-1);
+            }
+            size_t num_bytes = st.st_size;
+            void * mapped = mmap(NULL, num_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if(mapped == MAP_FAILED){
+                std::cerr << "Errors in mmap while loading metadata from " << metadata_file << std::endl;
+                exit(-1);
+            }
+            // caller owns (and frees) the metadata buffer
+            uint8_t * metadata = (uint8_t *) allocate(num_bytes);
+            memcpy(metadata, mapped, num_bytes);
+            munmap(mapped, num_bytes);
+            return metadata;
+        }
+
+        // views are owned by the mappings, nothing to free per retrieval
+        void release(){}
+
+        ~MmapLevelFileRetriever(){
+            for(int i=0; i<mapped_levels.size(); i++){
+                if(mapped_levels[i]) munmap(mapped_levels[i], mapped_sizes[i]);
+            }
+        }
+
+        void print() const {
+            std::cout << "Mmap file retriever." << std::endl;
+        }
+    private:
+        bool map_level(int i){
+            if(mapped_levels[i]) return true;
+            int fd = open(level_files[i].c_str(), O_RDONLY);
+            if(fd < 0) return false;
+            struct stat st;
+            if(fstat(fd, &st) || (st.st_size == 0)){
+                close(fd);
+                return false;
+            }
+            void * mapped = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if(mapped == MAP_FAILED) return false;
+            // bitplanes are requested in order
+            madvise(mapped, st.st_size, MADV_SEQUENTIAL);
+            mapped_levels[i] = (uint8_t *) mapped;
+            mapped_sizes[i] = st.st_size;
+            return true;
+        }
+
+        std::string metadata_file;
+        std::vector<std::string> level_files;
+        std::vector<uint64_t> offsets;
+        std::vector<uint8_t*> mapped_levels;
+        std::vector<size_t> mapped_sizes;
+    };
+}
+#endif
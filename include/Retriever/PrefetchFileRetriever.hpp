@@ -0,0 +1,209 @@
+#ifndef _MDR_PREFETCH_FILE_RETRIEVER_HPP
+#define _MDR_PREFETCH_FILE_RETRIEVER_HPP
+
+#include "RetrieverInterface.hpp"
+#include "Allocator/Allocator.hpp"
+#include <cstdio>
+#include <future>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace MDR {
+    // Data retriever for concatenated level files that reads the predicted next refinement in the background
+    // Prefetched ranges are handed over without I/O wait if they cover the next request
+    class PrefetchLevelFileRetriever : public concepts::RetrieverInterface {
+    public:
+        PrefetchLevelFileRetriever(const std::string& metadata_file, const std::vector<std::string>& level_files, int num_threads = 4) : metadata_file(metadata_file), level_files(level_files), num_threads(num_threads) {
+            offsets = std::vector<uint64_t>(level_files.size(), 0);
+            prefetched = std::vector<PrefetchedRange>(level_files.size());
+        }
+        // in-flight reads and buffers are not shared
+        PrefetchLevelFileRetriever(const PrefetchLevelFileRetriever& other) : PrefetchLevelFileRetriever(other.metadata_file, other.level_files, other.num_threads) {
+            offsets = other.offsets;
+        }
+        PrefetchLevelFileRetriever& operator=(const PrefetchLevelFileRetriever& other) = delete;
+
+        std::vector<std::vector<const uint8_t*>> retrieve_level_components(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<uint64_t>& retrieve_sizes, const std::vector<uint8_t>& prev_level_num_bitplanes, const std::vector<uint8_t>& level_num_bitplanes){
+            assert(offsets.size() == retrieve_sizes.size());
+            release();
+            wait_prefetch();
+            uint64_t total_retrieve_size = 0;
+            std::vector<PrefetchedRange> requests(level_files.size());
+            for(int i=0; i<level_files.size(); i++){
+                std::cout << + level_num_bitplanes[i] << +"," ; // numbers of bitplanes
+                requests[i] = take_prefetched(i, retrieve_sizes[i]);
+            }
+            // read what was not prefetched
+            if(!read_ranges(requests)){
+                for(int i=0; i<level_files.size(); i++){
+                    deallocate(requests[i].buffer);
+                }
+                std::cerr << "Errors in retrieving level components, nothing is returned" << std::endl;
+                return std::vector<std::vector<const uint8_t*>>();
+            }
+            for(int i=0; i<level_files.size(); i++){
+                concated_level_components.push_back(requests[i].buffer);
+                offsets[i] += retrieve_sizes[i];
+                total_retrieve_size += offsets[i];
+            }
+            std::cout << "Total_retrieve_size," << total_retrieve_size << ",";
+            return interleave_level_components(level_sizes, prev_level_num_bitplanes, level_num_bitplanes);
+        }
+
+        // read the predicted ranges in the background, starting at the current offsets
+        void prefetch(const std::vector<uint64_t>& retrieve_sizes){
+            assert(offsets.size() == retrieve_sizes.size());
+            wait_prefetch();
+            std::vector<PrefetchedRange> requests(level_files.size());
+            for(int i=0; i<level_files.size(); i++){
+                deallocate(prefetched[i].buffer);
+                prefetched[i] = PrefetchedRange();
+                if(retrieve_sizes[i] == 0) continue;
+                requests[i].offset = offsets[i];
+                requests[i].size = retrieve_sizes[i];
+                requests[i].buffer = (uint8_t *) allocate(retrieve_sizes[i]);
+            }
+            prefetched = requests;
+            pending = std::async(std::launch::async, [this](){ read_ranges(prefetched); });
+        }
+
+        uint8_t * load_metadata() const {
+            FILE * file = fopen(metadata_file.c_str(), "r");
+            fseek(file, 0, SEEK_END);
+            size_t num_bytes = ftell(file);
+            rewind(file);
+            uint8_t * metadata = (uint8_t *) allocate(num_bytes);
+            fread(metadata, 1, num_bytes, file);
+            fclose(file);
+            return metadata;
+        }
+
+        void release(){
+            for(int i=0; i<concated_level_components.size(); i++){
+                deallocate(concated_level_components[i]);
+            }
+            concated_level_components.clear();
+        }
+
+        ~PrefetchLevelFileRetriever(){
+            wait_prefetch();
+            for(int i=0; i<prefetched.size(); i++){
+                deallocate(prefetched[i].buffer);
+            }
+            release();
+        }
+
+        void print() const {
+            std::cout << "Prefetch file retriever." << std::endl;
+        }
+    private:
+        // byte range [offset, offset + size) of a level file; read_size bytes are already in buffer
+        struct PrefetchedRange{
+            uint64_t offset = 0;
+            uint64_t size = 0;
+            uint64_t read_size = 0;
+            uint8_t * buffer = NULL;
+        };
+
+        void wait_prefetch(){
+            if(pending.valid()) pending.get();
+        }
+
+        // build the request for level i, reusing the prefetched range if it starts at the current offset
+        PrefetchedRange take_prefetched(int i, uint64_t retrieve_size){
+            PrefetchedRange request;
+            request.offset = offsets[i];
+            request.size = retrieve_size;
+            PrefetchedRange& p = prefetched[i];
+            if(p.buffer && (p.offset == offsets[i])){
+                if(p.size <= retrieve_size){
+                    // under-predicted: keep the prefix and read the rest
+                    request.buffer = (uint8_t *) reallocate(p.buffer, retrieve_size);
+                    request.read_size = p.read_size;
+                    p = PrefetchedRange();
+                }
+                else{
+                    // over-predicted: hand over the prefix and keep the surplus for the next request
+                    request.buffer = p.buffer;
+                    request.read_size = std::min(p.read_size, retrieve_size);
+                    uint64_t surplus = p.size - retrieve_size;
+                    uint8_t * rest = (uint8_t *) allocate(surplus);
+                    memcpy(rest, p.buffer + retrieve_size, surplus);
+                    p.buffer = rest;
+                    p.offset += retrieve_size;
+                    p.size = surplus;
+                    p.read_size = (p.read_size > retrieve_size) ? p.read_size - retrieve_size : 0;
+                }
+                return request;
+            }
+            // mismatched prediction
+            deallocate(p.buffer);
+            p = PrefetchedRange();
+            request.buffer = (uint8_t *) allocate(retrieve_size > 0 ? retrieve_size : 1);
+            return request;
+        }
+
+        // pread the unread part of every range, spread over the worker threads
+        // a range that fails keeps its read_size, so a failed prefetch is read again on request
+        bool read_ranges(std::vector<PrefetchedRange>& ranges) const {
+            const int n = ranges.size();
+            const int num_workers = std::max(1, std::min(num_threads, n));
+            std::vector<std::future<bool>> workers;
+            for(int t=0; t<num_workers; t++){
+                workers.push_back(std::async(std::launch::async, [this, &ranges, t, n, num_workers](){
+                    bool success = true;
+                    for(int i=t; i<n; i+=num_workers){
+                        success = read_range(level_files[i], ranges[i]) && success;
+                    }
+                    return success;
+                }));
+            }
+            bool success = true;
+            for(auto& w:workers) success = w.get() && success;
+            return success;
+        }
+
+        static bool read_range(const std::string& filename, PrefetchedRange& range){
+            if(range.read_size >= range.size) return true;
+            int fd = open(filename.c_str(), O_RDONLY);
+            if(fd < 0){
+                std::cerr << "Errors in open while retrieving from file " << filename << std::endl;
+                return false;
+            }
+            while(range.read_size < range.size){
+                ssize_t count = pread(fd, range.buffer + range.read_size, range.size - range.read_size, range.offset + range.read_size);
+                if(count <= 0){
+                    std::cerr << "Errors in pread while retrieving from file " << filename << std::endl;
+                    break;
+                }
+                range.read_size += count;
+            }
+            close(fd);
+            return range.read_size >= range.size;
+        }
+
+        std::vector<std::vector<const uint8_t*>> interleave_level_components(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<uint8_t>& prev_level_num_bitplanes, const std::vector<uint8_t>& level_num_bitplanes){
+            std::vector<std::vector<const uint8_t*>> level_components;
+            for(int i=0; i<level_num_bitplanes.size(); i++){
+                const uint8_t * pos = concated_level_components[i];
+                std::vector<const uint8_t*> interleaved_level;
+                for(int j=prev_level_num_bitplanes[i]; j<level_num_bitplanes[i]; j++){
+                    interleaved_level.push_back(pos);
+                    pos += level_sizes[i][j];
+                }
+                level_components.push_back(interleaved_level);
+            }
+            return level_components;
+        }
+
+        std::string metadata_file;
+        std::vector<std::string> level_files;
+        int num_threads;
+        std::vector<uint64_t> offsets;
+        std::vector<uint8_t*> concated_level_components;
+        std::vector<PrefetchedRange> prefetched;
+        std::future<void> pending;
+    };
+}
+#endif
@@ -0,0 +1,157 @@
+#ifndef _MDR_REORGANIZED_FILE_RETRIEVER_HPP
+#define _MDR_REORGANIZED_FILE_RETRIEVER_HPP
+
+#include "RetrieverInterface.hpp"
+#include "RefactorUtils.hpp"
+#include "Allocator/Allocator.hpp"
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace MDR {
+    // Data retriever for the single data file written by ReorganizedFileWriter
+    // the requested bitplanes are located through the order table and read as runs of adjacent bitplanes:
+    // a request following the layout order (e.g. RateDistortionSizeInterpreter over RateDistortionReorganizer)
+    // is one contiguous read continuing the previous one
+    class ReorganizedFileRetriever : public concepts::RetrieverInterface {
+    public:
+        ReorganizedFileRetriever(const std::string& metadata_file, const std::string& data_file) : metadata_file(metadata_file), data_file(data_file) {
+            if(!load_order()){
+                std::cerr << "Errors in loading order table from " << metadata_file << std::endl;
+                exit(-1);
+            }
+        }
+
+        std::vector<std::vector<const uint8_t*>> retrieve_level_components(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<uint64_t>& retrieve_sizes, const std::vector<uint8_t>& prev_level_num_bitplanes, const std::vector<uint8_t>& level_num_bitplanes){
+            release();
+            if(bitplane_offsets.empty()) locate_bitplanes(level_sizes);
+            const int num_levels = level_num_bitplanes.size();
+            uint64_t total_retrieve_size = 0;
+            for(int i=0; i<num_levels; i++){
+                std::cout << + level_num_bitplanes[i] << +"," ; // numbers of bitplanes
+                for(int j=0; j<level_num_bitplanes[i]; j++){
+                    total_retrieve_size += level_sizes[i][j];
+                }
+            }
+            // requested bitplanes in file order, merged into runs of adjacent bitplanes
+            std::vector<std::vector<const uint8_t*>> level_components(num_levels);
+            std::vector<uint32_t> index(num_levels, 0);
+            std::vector<std::pair<uint32_t, uint32_t>> requested;
+            for(uint32_t k=0; k<order.size(); k++){
+                int i = order[k];
+                int j = index[i] ++;
+                if(j >= prev_level_num_bitplanes[i] && j < level_num_bitplanes[i]) requested.push_back(std::make_pair(k, i));
+            }
+            int fd = open(data_file.c_str(), O_RDONLY);
+            if(fd < 0){
+                std::cerr << "Errors in open while retrieving from file " << data_file << std::endl;
+                return std::vector<std::vector<const uint8_t*>>();
+            }
+            for(size_t r=0; r<requested.size(); ){
+                size_t end = r + 1;
+                while(end < requested.size() && requested[end].first == requested[end - 1].first + 1) end ++;
+                uint64_t offset = bitplane_offsets[requested[r].first];
+                uint64_t size = bitplane_offsets[requested[end - 1].first + 1] - offset;
+                uint8_t * buffer = (uint8_t *) allocate(size > 0 ? size : 1);
+                runs.push_back(buffer);
+                if(!read_all(fd, buffer, size, offset)){
+                    close(fd);
+                    release();
+                    return std::vector<std::vector<const uint8_t*>>();
+                }
+                for(size_t t=r; t<end; t++){
+                    level_components[requested[t].second].push_back(buffer + (bitplane_offsets[requested[t].first] - offset));
+                }
+                r = end;
+            }
+            close(fd);
+            std::cout << "Total_retrieve_size," << total_retrieve_size << ",";
+            return level_components;
+        }
+
+        void prefetch(const std::vector<uint64_t>& retrieve_sizes){}
+
+        uint8_t * load_metadata() const {
+            FILE * file = fopen(metadata_file.c_str(), "r");
+            if(file == NULL){
+                std::cerr << "Errors in loading metadata from " << metadata_file << std::endl;
+                exit(-1);
+            }
+            uint8_t * metadata = (uint8_t *) allocate(metadata_size);
+            if(fread(metadata, 1, metadata_size, file) != metadata_size){
+                std::cerr << "Errors in reading metadata from " << metadata_file << std::endl;
+            }
+            fclose(file);
+            return metadata;
+        }
+
+        void release(){
+            for(int i=0; i<runs.size(); i++){
+                deallocate(runs[i]);
+            }
+            runs.clear();
+        }
+
+        ~ReorganizedFileRetriever(){
+            release();
+        }
+
+        void print() const {
+            std::cout << "Reorganized file retriever." << std::endl;
+        }
+    private:
+        bool load_order(){
+            FILE * file = fopen(metadata_file.c_str(), "r");
+            if(file == NULL) return false;
+            fseek(file, 0, SEEK_END);
+            long num_bytes = ftell(file);
+            ReorganizedTrailer trailer;
+            bool success = (num_bytes >= (long) sizeof(ReorganizedTrailer));
+            if(success){
+                fseek(file, num_bytes - sizeof(ReorganizedTrailer), SEEK_SET);
+                success = (fread(&trailer, sizeof(ReorganizedTrailer), 1, file) == 1) && (trailer.magic == MDR_REORGANIZED_MAGIC);
+            }
+            if(success){
+                metadata_size = trailer.metadata_size;
+                order = std::vector<uint8_t>(trailer.num_bitplanes);
+                fseek(file, metadata_size, SEEK_SET);
+                success = (fread(order.data(), sizeof(uint8_t), trailer.num_bitplanes, file) == trailer.num_bitplanes);
+            }
+            fclose(file);
+            return success;
+        }
+
+        // offset of every bitplane in file order, followed by the data size
+        void locate_bitplanes(const std::vector<std::vector<uint64_t>>& level_sizes){
+            std::vector<uint32_t> index(level_sizes.size(), 0);
+            uint64_t offset = 0;
+            for(const auto& i:order){
+                bitplane_offsets.push_back(offset);
+                offset += level_sizes[i][index[i] ++];
+            }
+            bitplane_offsets.push_back(offset);
+        }
+
+        bool read_all(int fd, uint8_t * buffer, uint64_t size, uint64_t offset) const {
+            while(size > 0){
+                ssize_t count = pread(fd, buffer, size, offset);
+                if(count <= 0){
+                    std::cerr << "Errors in pread while retrieving from " << data_file << std::endl;
+                    return false;
+                }
+                buffer += count;
+                size -= count;
+                offset += count;
+            }
+            return true;
+        }
+
+        std::string metadata_file;
+        std::string data_file;
+        uint64_t metadata_size = 0;
+        std::vector<uint8_t> order;
+        std::vector<uint64_t> bitplane_offsets;
+        std::vector<uint8_t*> runs;
+    };
+}
+#endif
@@ -2,5 +2,11 @@
 #define _MDR_RETRIEVER_HPP
 
 #include "FileRetriever.hpp"
+#include "MmapFileRetriever.hpp"
+#include "PrefetchFileRetriever.hpp"
+#include "ContainerFileRetriever.hpp"
+#include "HPSSFileRetriever.hpp"
+#include "InMemoryRetriever.hpp"
+#include "ReorganizedFileRetriever.hpp"
 
 #endif
@@ -12,7 +12,11 @@ namespace MDR {
 
             virtual ~RetrieverInterface() = default;
 
-            virtual std::vector<std::vector<const uint8_t*>> retrieve_level_components(const std::vector<std::vector<uint32_t>>& level_sizes, const std::vector<uint32_t>& retrieve_sizes, const std::vector<uint8_t>& prev_level_num_bitplanes, const std::vector<uint8_t>& level_num_bitplanes) = 0;
+            // no levels are returned if the requested bytes cannot be read
+            virtual std::vector<std::vector<const uint8_t*>> retrieve_level_components(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<uint64_t>& retrieve_sizes, const std::vector<uint8_t>& prev_level_num_bitplanes, const std::vector<uint8_t>& level_num_bitplanes) = 0;
+
+            // hint that the next retrieval will likely request retrieve_sizes more bytes per level
+            virtual void prefetch(const std::vector<uint64_t>& retrieve_sizes) = 0;
 
             virtual uint8_t * load_metadata() const = 0;
 
@@ -0,0 +1,98 @@
+#ifndef _MDR_BUDGET_SIZE_INTERPRETER_HPP
+#define _MDR_BUDGET_SIZE_INTERPRETER_HPP
+
+#include "SizeInterpreterInterface.hpp"
+#include "GreedyBasedSizeInterpreter.hpp"
+
+namespace MDR {
+    // greedy bit-plane retrieval under a byte budget per request
+    // retrieves by unit error gain until the tolerance is met or no next bitplane fits in the remaining budget
+    template<class ErrorEstimator>
+    class BudgetGreedyBasedSizeInterpreter : public concepts::SizeInterpreterInterface {
+    public:
+        BudgetGreedyBasedSizeInterpreter(const ErrorEstimator& e, uint64_t budget) : budget(budget) {
+            error_estimator = e;
+        }
+        std::vector<uint64_t> interpret_retrieve_size(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const {
+            return interpret_retrieve_size(level_sizes, level_errors, tolerance, budget, index);
+        }
+        void set_budget(uint64_t b){
+            budget = b;
+        }
+        void print() const {
+            std::cout << "Byte budget greedy based size interpreter (budget = " << budget << ")." << std::endl;
+        }
+    protected:
+        std::vector<uint64_t> interpret_retrieve_size(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, uint64_t budget, std::vector<uint8_t>& index) const {
+            const int num_levels = level_sizes.size();
+            std::vector<uint64_t> retrieve_sizes(num_levels, 0);
+
+            double accumulated_error = 0;
+            for(int i=0; i<num_levels; i++){
+                accumulated_error += error_estimator.estimate_error(level_errors[i][index[i]], i);
+            }
+            std::priority_queue<UnitErrorGain, std::vector<UnitErrorGain>, CompareUnitErrorGain> heap;
+            for(int i=0; i<num_levels; i++){
+                if(index[i] == level_sizes[i].size()) continue;
+                double error_gain = error_estimator.estimate_error_gain(accumulated_error, level_errors[i][index[i]], level_errors[i][index[i] + 1], i);
+                heap.push(UnitErrorGain(error_gain / level_sizes[i][index[i]], i));
+            }
+
+            uint64_t remaining_budget = budget;
+            while((accumulated_error >= tolerance) && (!heap.empty())){
+                auto unit_error_gain = heap.top();
+                heap.pop();
+                int i = unit_error_gain.level;
+                int j = index[i];
+                // bitplanes of a level are retrieved in order: a level stops once its next bitplane does not fit
+                if(level_sizes[i][j] > remaining_budget) continue;
+                remaining_budget -= level_sizes[i][j];
+                retrieve_sizes[i] += level_sizes[i][j];
+                accumulated_error -= error_estimator.estimate_error(level_errors[i][j], i);
+                accumulated_error += error_estimator.estimate_error(level_errors[i][j + 1], i);
+                index[i] ++;
+                if(index[i] != level_sizes[i].size()){
+                    double error_gain = error_estimator.estimate_error_gain(accumulated_error, level_errors[i][index[i]], level_errors[i][index[i] + 1], i);
+                    heap.push(UnitErrorGain(error_gain / level_sizes[i][index[i]], i));
+                }
+            }
+            if(!quiet) std::cout << "Requested tolerance = " << tolerance << ", budget = " << budget << ", retrieved = " << budget - remaining_budget << ", estimated error = " << accumulated_error << std::endl;
+            return retrieve_sizes;
+        }
+
+        ErrorEstimator error_estimator;
+        uint64_t budget;
+    };
+
+    // greedy bit-plane retrieval under a latency deadline per request
+    // the deadline is converted into a byte budget with the measured retrieval throughput (exponential moving average)
+    template<class ErrorEstimator>
+    class DeadlineGreedyBasedSizeInterpreter : public BudgetGreedyBasedSizeInterpreter<ErrorEstimator> {
+    public:
+        DeadlineGreedyBasedSizeInterpreter(const ErrorEstimator& e, double deadline, double initial_throughput = 100.0 * 1024 * 1024, double smoothing = 0.5)
+            : BudgetGreedyBasedSizeInterpreter<ErrorEstimator>(e, 0), deadline(deadline), throughput(initial_throughput), smoothing(smoothing) {}
+        std::vector<uint64_t> interpret_retrieve_size(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const {
+            uint64_t deadline_budget = deadline * throughput;
+            return BudgetGreedyBasedSizeInterpreter<ErrorEstimator>::interpret_retrieve_size(level_sizes, level_errors, tolerance, deadline_budget, index);
+        }
+        void set_deadline(double d){
+            deadline = d;
+        }
+        // throughput in bytes per second
+        double get_throughput() const {
+            return throughput;
+        }
+        void record_retrieval(uint64_t retrieved_size, double seconds){
+            if((retrieved_size == 0) || (seconds <= 0)) return;
+            throughput = smoothing * (retrieved_size / seconds) + (1 - smoothing) * throughput;
+        }
+        void print() const {
+            std::cout << "Deadline greedy based size interpreter (deadline = " << deadline << "s, throughput = " << throughput << " B/s)." << std::endl;
+        }
+    private:
+        double deadline;
+        double throughput;
+        double smoothing;
+    };
+}
+#endif
@@ -8,9 +8,6 @@
 
 // inorder and round-robin size interpreter
 
-extern std::vector<double> cc;
-extern double c;
-
 namespace MDR {
     struct UnitErrorGain{
         double unit_error_gain;
@@ -29,9 +26,9 @@ namespace MDR {
         GreedyBasedSizeInterpreter(const ErrorEstimator& e){
             error_estimator = e;
         }
-        std::vector<uint32_t> interpret_retrieve_size(const std::vector<std::vector<uint32_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const {
+        std::vector<uint64_t> interpret_retrieve_size(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const {
             const int num_levels = level_sizes.size();
-            std::vector<uint32_t> retrieve_sizes(num_levels, 0);
+            std::vector<uint64_t> retrieve_sizes(num_levels, 0);
 
             double accumulated_error = 0;
             for(int i=0; i<num_levels; i++){
@@ -39,6 +36,7 @@ namespace MDR {
             }
             std::priority_queue<UnitErrorGain, std::vector<UnitErrorGain>, CompareUnitErrorGain> heap;
             for(int i=0; i<num_levels; i++){
+                if(index[i] == level_sizes[i].size()) continue;
                 double error_gain = error_estimator.estimate_error_gain(accumulated_error, level_errors[i][index[i]], level_errors[i][index[i] + 1], i);
                 heap.push(UnitErrorGain(error_gain / level_sizes[i][index[i]], i));
             }            
@@ -60,10 +58,12 @@ namespace MDR {
                     double error_gain = error_estimator.estimate_error_gain(accumulated_error, level_errors[i][index[i]], level_errors[i][index[i] + 1], i);
                     heap.push(UnitErrorGain(error_gain / level_sizes[i][index[i]], i));
                 }
-                std::cout << i;
+                if(!quiet) std::cout << i;
+            }
+            if(!quiet){
+                std::cout << std::endl;
+                std::cout << "Requested tolerance = " << std::setprecision (15) << tolerance << ", estimated error = " << std::setprecision (15) << accumulated_error << ", "; //<< std::endl;
             }
-            std::cout << std::endl;
-            std::cout << "Requested tolerance = " << std::setprecision (15) << tolerance << ", estimated error = " << std::setprecision (15) << accumulated_error << ", "; //<< std::endl;
             return retrieve_sizes;
         }
         void print() const {
@@ -79,7 +79,7 @@ namespace MDR {
         SignExcludeGreedyBasedSizeInterpreter(const ErrorEstimator& e){
             error_estimator = e;
         }
-        std::vector<uint32_t> interpret_retrieve_size(const std::vector<std::vector<uint32_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const {
+        std::vector<uint64_t> interpret_retrieve_size(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const {
             //for(int i=0; i<level_errors.size(); i++){
             //    for(int j=0; j<level_errors[i].size(); j++){
             //        std::cout << level_errors[i][j] << " ";
@@ -87,13 +87,7 @@ namespace MDR {
             //    std::cout << std::endl;
             //}
 
-            //c = 1.0 + 21.0*sqrt(3)/8;
-
             int num_levels = level_sizes.size();
-            for(int i=0; i< num_levels; i++){
-                std::cout << cc[i] <<",";
-            }
-            
             // // print level size
             // for(int i=0; i< num_levels; i++){
             //     for(int j=0; j < 32; j++){
@@ -102,12 +96,9 @@ namespace MDR {
             //     std::cout << "\n";
             // }
 
-            std::vector<uint32_t> retrieve_sizes(num_levels, 0);
+            std::vector<uint64_t> retrieve_sizes(num_levels, 0);
             double accumulated_error = 0;
             for(int i=0; i<num_levels; i++){
-        		c = cc[i];
-        		//c = 1.0 + 21.0*sqrt(3)/8;
-        		c *= 4;
                 accumulated_error += error_estimator.estimate_error(level_errors[i][index[i]], i);
                 //std::cout << "accumulated_error: " << accumulated_error << ", level_error: " << level_errors[i][index[i]] << std::endl;
             }
@@ -115,9 +106,6 @@ namespace MDR {
             // identify minimal level
             double min_error = accumulated_error;
             for(int i=0; i<num_levels; i++){
-        		c = cc[i];
-        		//c = 1.0 + 21.0*sqrt(3)/8;
-        		c *= 4;
                 min_error -= error_estimator.estimate_error(level_errors[i][index[i]], i);
                 min_error += error_estimator.estimate_error(level_errors[i].back(), i);
                 // fetch the first component if index is 0
@@ -146,9 +134,6 @@ namespace MDR {
                 heap.pop();
                 int i = unit_error_gain.level;
                 int j = index[i];
-        		c = cc[i];
-        		//c = 1.0 + 21.0*sqrt(3)/8;
-        		c *= 4;
                 retrieve_sizes[i] += level_sizes[i][j];
                 accumulated_error -= error_estimator.estimate_error(level_errors[i][j], i);
                 accumulated_error += error_estimator.estimate_error(level_errors[i][j + 1], i);
@@ -164,7 +149,7 @@ namespace MDR {
             }
             //std::cout << std::endl;
             //std::cout << "Requested tolerance = " << tolerance << ", estimated error = " << accumulated_error << std::endl;
-            std::cout << "Requested_tolerance," << tolerance << ",estimated_error," << accumulated_error << ","; //<< std::endl;
+            if(!quiet) std::cout << "Requested_tolerance," << tolerance << ",estimated_error," << accumulated_error << ","; //<< std::endl;
             return retrieve_sizes;
         }
         void print() const {
@@ -192,9 +177,9 @@ namespace MDR {
         NegaBinaryGreedyBasedSizeInterpreter(const ErrorEstimator& e){
             error_estimator = e;
         }
-        std::vector<uint32_t> interpret_retrieve_size(const std::vector<std::vector<uint32_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const {
+        std::vector<uint64_t> interpret_retrieve_size(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const {
             int num_levels = level_sizes.size();
-            std::vector<uint32_t> retrieve_sizes(num_levels, 0);
+            std::vector<uint64_t> retrieve_sizes(num_levels, 0);
             double accumulated_error = 0;
             for(int i=0; i<num_levels; i++){
                 accumulated_error += error_estimator.estimate_error(level_errors[i][index[i]], i);
@@ -246,21 +231,21 @@ namespace MDR {
                 //for(int k=0; k<num; k++) std::cout << i;
             }
             //std::cout << std::endl;
-            std::cout << "Requested tolerance = " << tolerance << ", estimated error = " << accumulated_error << std::endl;
+            if(!quiet) std::cout << "Requested tolerance = " << tolerance << ", estimated error = " << accumulated_error << std::endl;
             return retrieve_sizes;
         }
         void print() const {
             std::cout << "Greedy based size interpreter for negabinary encoding." << std::endl;
         }
     private:
-        inline ConsecutiveUnitErrorGain estimated_efficiency(double accumulated_error, int index, int level, const std::vector<double>& bitplane_errors, const std::vector<uint32_t>& bitplane_sizes) const {
+        inline ConsecutiveUnitErrorGain estimated_efficiency(double accumulated_error, int index, int level, const std::vector<double>& bitplane_errors, const std::vector<uint64_t>& bitplane_sizes) const {
             double current_error_gain = error_estimator.estimate_error_gain(accumulated_error, bitplane_errors[index], bitplane_errors[index + 1], level);
-            uint32_t current_size = bitplane_sizes[index];
+            uint64_t current_size = bitplane_sizes[index];
             double current_efficiency = current_error_gain / current_size;
             int consecutive_num = 1;
             for(int i=2; i<bitplane_sizes.size() - index; i++){
                 double next_error_gain = error_estimator.estimate_error_gain(accumulated_error, bitplane_errors[index], bitplane_errors[index + i], level);             
-                uint32_t next_size = current_size + bitplane_sizes[index + i - 1];
+                uint64_t next_size = current_size + bitplane_sizes[index + i - 1];
                 double next_efficiency = next_error_gain / next_size;
                 if((current_efficiency > 0) && (current_efficiency > next_efficiency)){
                     break;
@@ -0,0 +1,166 @@
+#ifndef _MDR_OPTIMAL_SIZE_INTERPRETER_HPP
+#define _MDR_OPTIMAL_SIZE_INTERPRETER_HPP
+
+#include "SizeInterpreterInterface.hpp"
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+namespace MDR {
+    // Pareto frontier of (retrieved size, estimated error) over the bitplane counts of levels 0..l
+    // points are sorted by increasing size and strictly decreasing error; each point records
+    // the number of bitplanes of level l and its parent point in the frontier of levels 0..l-1
+    struct SizeErrorFrontier{
+        std::vector<uint64_t> sizes;
+        std::vector<double> errors;
+        std::vector<uint32_t> parents;
+        std::vector<uint8_t> num_bitplanes;
+
+        size_t size() const {
+            return sizes.size();
+        }
+    };
+
+    // exact minimum-size bit-plane retrieval: the estimated error is the sum of the per-level estimates,
+    // so the optimal bitplane counts are found by dynamic programming over levels, merging the Pareto frontier
+    // of the previous levels with every bitplane count of the next level and dropping dominated points
+    // the frontiers are built on the first query and cached; a query is a binary search plus a backtrack over levels
+    // if the optimum for a tolerance needs fewer bitplanes than already retrieved on some level,
+    // the frontiers are rebuilt with the retrieved bitplanes as lower bounds
+    // frontiers grow with every level: beyond max_frontier_size points, only the smallest point of each
+    // of max_frontier_size log-spaced error buckets is kept, so the selection stays within the tolerance
+    // and is optimal up to one bucket width of error
+    template<class ErrorEstimator>
+    class OptimalSizeInterpreter : public concepts::SizeInterpreterInterface {
+    public:
+        OptimalSizeInterpreter(const ErrorEstimator& e, size_t max_frontier_size = 1 << 14) : max_frontier_size(std::max<size_t>(max_frontier_size, 2)) {
+            error_estimator = e;
+        }
+        std::vector<uint64_t> interpret_retrieve_size(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const {
+            auto locate = [tolerance](const SizeErrorFrontier& f){
+                // first point below tolerance, the most accurate one if none
+                size_t k = std::partition_point(f.errors.begin(), f.errors.end(), [tolerance](double e){ return e >= tolerance; }) - f.errors.begin();
+                return std::min(k, f.size() - 1);
+            };
+            return retrieve(level_sizes, level_errors, index, locate, "tolerance", tolerance);
+        }
+        // retrieve sizes with the minimal estimated error such that the total retrieved size (including previous retrievals) stays within budget
+        std::vector<uint64_t> interpret_retrieve_size_by_budget(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, uint64_t budget, std::vector<uint8_t>& index) const {
+            auto locate = [budget](const SizeErrorFrontier& f){
+                size_t k = std::upper_bound(f.sizes.begin(), f.sizes.end(), budget) - f.sizes.begin();
+                return (k > 0) ? k - 1 : 0;
+            };
+            return retrieve(level_sizes, level_errors, index, locate, "budget", budget);
+        }
+        void print() const {
+            std::cout << "Optimal (dynamic programming) size interpreter." << std::endl;
+        }
+    private:
+        template<class Locate, class Request>
+        std::vector<uint64_t> retrieve(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, std::vector<uint8_t>& index, Locate locate, const char * request_name, Request request) const {
+            const int num_levels = level_sizes.size();
+            if(frontiers.empty()) build_frontiers(level_sizes, level_errors, std::vector<uint8_t>(num_levels, 0));
+            std::vector<uint8_t> target = backtrack(locate(frontiers.back()));
+            bool below_retrieved = false;
+            for(int i=0; i<num_levels; i++){
+                if(target[i] < index[i]) below_retrieved = true;
+            }
+            if(below_retrieved){
+                build_frontiers(level_sizes, level_errors, index);
+                target = backtrack(locate(frontiers.back()));
+            }
+            std::vector<uint64_t> retrieve_sizes(num_levels, 0);
+            double estimated_error = 0;
+            for(int i=0; i<num_levels; i++){
+                for(int j=index[i]; j<target[i]; j++){
+                    retrieve_sizes[i] += level_sizes[i][j];
+                }
+                index[i] = std::max(index[i], target[i]);
+                estimated_error += error_estimator.estimate_error(level_errors[i][index[i]], i);
+            }
+            if(!quiet) std::cout << "Requested " << request_name << " = " << request << ", estimated error = " << estimated_error << std::endl;
+            return retrieve_sizes;
+        }
+
+        // bitplane counts per level of point k of the last frontier
+        std::vector<uint8_t> backtrack(size_t k) const {
+            std::vector<uint8_t> num_bitplanes(frontiers.size(), 0);
+            for(int i=frontiers.size()-1; i>=0; i--){
+                num_bitplanes[i] = frontiers[i].num_bitplanes[k];
+                k = frontiers[i].parents[k];
+            }
+            return num_bitplanes;
+        }
+
+        // frontiers of levels 0..i for every i, with at least min_bitplanes[i] bitplanes on level i
+        void build_frontiers(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, const std::vector<uint8_t>& min_bitplanes) const {
+            struct Candidate{
+                uint64_t size;
+                double error;
+                uint32_t parent;
+                uint8_t num_bitplanes;
+            };
+            const int num_levels = level_sizes.size();
+            frontiers.clear();
+            SizeErrorFrontier prev;
+            prev.sizes.push_back(0);
+            prev.errors.push_back(0);
+            prev.parents.push_back(0);
+            prev.num_bitplanes.push_back(0);
+            std::vector<Candidate> candidates;
+            for(int i=0; i<num_levels; i++){
+                // cumulative size and estimated error of retrieving the first k bitplanes of level i
+                const int max_bitplanes = level_sizes[i].size();
+                std::vector<uint64_t> sizes(max_bitplanes + 1, 0);
+                std::partial_sum(level_sizes[i].begin(), level_sizes[i].end(), sizes.begin() + 1);
+                candidates.clear();
+                for(uint32_t p=0; p<prev.size(); p++){
+                    for(int k=min_bitplanes[i]; k<=max_bitplanes; k++){
+                        candidates.push_back({prev.sizes[p] + sizes[k], prev.errors[p] + error_estimator.estimate_error(level_errors[i][k], i), p, (uint8_t) k});
+                    }
+                }
+                std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b){
+                    return (a.size < b.size) || ((a.size == b.size) && (a.error < b.error));
+                });
+                // keep the points that are more accurate than every smaller one
+                SizeErrorFrontier current;
+                for(const auto& c:candidates){
+                    if(current.size() && (c.error >= current.errors.back())) continue;
+                    current.sizes.push_back(c.size);
+                    current.errors.push_back(c.error);
+                    current.parents.push_back(c.parent);
+                    current.num_bitplanes.push_back(c.num_bitplanes);
+                }
+                if(current.size() > max_frontier_size) thin(current);
+                frontiers.push_back(current);
+                prev = std::move(current);
+            }
+        }
+
+        // keep the first (smallest) point of every log-spaced error bucket, and the most accurate point
+        void thin(SizeErrorFrontier& f) const {
+            const size_t n = f.size();
+            // errors are strictly decreasing, only the last one can be zero
+            const size_t last_positive = (f.errors[n - 1] > 0) ? n - 1 : n - 2;
+            const double log_max = log(f.errors[0]);
+            const double width = (log_max - log(f.errors[last_positive])) / (max_frontier_size - 1);
+            SizeErrorFrontier thinned;
+            int64_t prev_bucket = -1;
+            for(size_t k=0; k<n; k++){
+                int64_t bucket = (k <= last_positive && width > 0) ? (int64_t) ((log_max - log(f.errors[k])) / width) : (int64_t) max_frontier_size;
+                if(bucket == prev_bucket && k != n - 1) continue;
+                prev_bucket = bucket;
+                thinned.sizes.push_back(f.sizes[k]);
+                thinned.errors.push_back(f.errors[k]);
+                thinned.parents.push_back(f.parents[k]);
+                thinned.num_bitplanes.push_back(f.num_bitplanes[k]);
+            }
+            f = std::move(thinned);
+        }
+
+        ErrorEstimator error_estimator;
+        size_t max_frontier_size;
+        mutable std::vector<SizeErrorFrontier> frontiers;
+    };
+}
+#endif
@@ -0,0 +1,175 @@
+#ifndef _MDR_RATE_DISTORTION_INDEX_HPP
+#define _MDR_RATE_DISTORTION_INDEX_HPP
+
+#include <queue>
+#include <algorithm>
+#include "RefactorUtils.hpp"
+#include "ErrorEstimator/ErrorEstimator.hpp"
+#include "ErrorCollector/ErrorCollector.hpp"
+
+namespace MDR {
+    // kind of error estimator: the per-level scales alone do not tell max and squared error estimators apart
+    template<class T>
+    inline uint8_t estimator_kind(const MaxErrorEstimator<T> *){ return 1; }
+    template<class T>
+    inline uint8_t estimator_kind(const SquaredErrorEstimator<T> *){ return 2; }
+    inline uint8_t estimator_kind(const void *){ return 0; }
+
+    // Precomputed greedy retrieval order with the cumulative (size, estimated error) curve
+    // step k retrieves the next bitplane of level order[k]; sizes[k] and errors[k] hold the state after k steps
+    // the estimator that built the order is recorded by its kind and per-level scale estimate_error(1, level)
+    struct RateDistortionIndex{
+        std::vector<uint8_t> order;
+        std::vector<uint64_t> sizes;
+        std::vector<double> errors;
+        uint8_t estimator_kind = 0;
+        std::vector<double> estimator_scales;
+
+        bool empty() const {
+            return order.empty();
+        }
+        uint32_t num_steps() const {
+            return order.size();
+        }
+        // first step count whose estimated error is below tolerance (all steps if none)
+        uint32_t locate_tolerance(double tolerance) const {
+            // errors are kept non-increasing when the index is built
+            uint32_t k = std::partition_point(errors.begin(), errors.end(), [tolerance](double e){ return e >= tolerance; }) - errors.begin();
+            // errors has num_steps() + 1 entries, none below tolerance gives errors.size()
+            return std::min(k, num_steps());
+        }
+        // largest step count whose cumulative size fits in the budget
+        uint32_t locate_budget(uint64_t budget) const {
+            return std::upper_bound(sizes.begin(), sizes.end(), budget) - sizes.begin() - 1;
+        }
+        // sizes to retrieve per level for the bitplanes taken by the first `to` steps; index is advanced accordingly
+        // bitplanes already retrieved (index need not be a prefix of the order, e.g. after reconstructing to
+        // given bitplanes or with another interpreter) are skipped, and so are steps beyond the level sizes
+        // the walk stops at the first bitplane that does not fit in max_size
+        std::vector<uint64_t> retrieve_sizes(const std::vector<std::vector<uint64_t>>& level_sizes, uint32_t to, std::vector<uint8_t>& index, uint64_t max_size=UINT64_MAX) const {
+            std::vector<uint64_t> retrieve_sizes(level_sizes.size(), 0);
+            std::vector<uint32_t> taken(level_sizes.size(), 0);
+            uint64_t total_size = 0;
+            for(uint32_t k=0; k<to; k++){
+                int i = order[k];
+                if(i >= level_sizes.size()) continue;
+                uint32_t j = taken[i] ++;
+                if((j < index[i]) || (j >= level_sizes[i].size())) continue;
+                if(level_sizes[i][j] > max_size - total_size) break;
+                total_size += level_sizes[i][j];
+                retrieve_sizes[i] += level_sizes[i][j];
+                index[i] = j + 1;
+            }
+            return retrieve_sizes;
+        }
+        // whether the index was built by an estimator of this kind with the same per-level scales
+        template<class ErrorEstimator>
+        bool built_by(const ErrorEstimator& error_estimator) const {
+            if(estimator_kind != MDR::estimator_kind(&error_estimator)) return false;
+            for(int i=0; i<estimator_scales.size(); i++){
+                double scale = error_estimator.estimate_error(1, i);
+                if(fabs(scale - estimator_scales[i]) > 1e-6 * fabs(estimator_scales[i])) return false;
+            }
+            return !estimator_scales.empty();
+        }
+
+        uint64_t get_size() const {
+            return sizeof(uint32_t) + MDR::get_size(order) + MDR::get_size(sizes) + MDR::get_size(errors)
+                    + 2 * sizeof(uint8_t) + MDR::get_size(estimator_scales);
+        }
+        void serialize(uint8_t *& buffer_pos) const {
+            *reinterpret_cast<uint32_t*>(buffer_pos) = order.size();
+            buffer_pos += sizeof(uint32_t);
+            MDR::serialize(order, buffer_pos);
+            MDR::serialize(sizes, buffer_pos);
+            MDR::serialize(errors, buffer_pos);
+            *(buffer_pos ++) = estimator_kind;
+            *(buffer_pos ++) = (uint8_t) estimator_scales.size();
+            MDR::serialize(estimator_scales, buffer_pos);
+        }
+        // version 3 metadata does not record the estimator
+        void deserialize(uint8_t const *& buffer_pos, uint8_t version=MDR_METADATA_VERSION){
+            uint32_t n = *reinterpret_cast<const uint32_t*>(buffer_pos);
+            buffer_pos += sizeof(uint32_t);
+            MDR::deserialize(buffer_pos, n, order);
+            MDR::deserialize(buffer_pos, n + 1, sizes);
+            MDR::deserialize(buffer_pos, n + 1, errors);
+            estimator_kind = 0;
+            estimator_scales.clear();
+            if(version >= 4){
+                estimator_kind = *(buffer_pos ++);
+                uint8_t num_levels = *(buffer_pos ++);
+                MDR::deserialize(buffer_pos, num_levels, estimator_scales);
+            }
+        }
+    };
+
+    // level errors seen by the error estimator: bitplane max errors for max error estimators, collected squared errors otherwise
+    template<class T, class ErrorEstimator>
+    std::vector<std::vector<double>> compute_estimator_level_errors(const std::vector<T>& level_error_bounds, const std::vector<std::vector<double>>& level_squared_errors){
+        if(std::is_base_of<MaxErrorEstimator<T>, ErrorEstimator>::value){
+            std::vector<std::vector<double>> level_abs_errors;
+            MaxErrorCollector<T> collector = MaxErrorCollector<T>();
+            for(int i=0; i<level_error_bounds.size(); i++){
+                level_abs_errors.push_back(collector.collect_level_error(NULL, 0, level_squared_errors[i].size(), level_error_bounds[i]));
+            }
+            return level_abs_errors;
+        }
+        else if(std::is_base_of<SquaredErrorEstimator<T>, ErrorEstimator>::value){
+            return level_squared_errors;
+        }
+        std::cerr << "Customized error estimator not supported yet" << std::endl;
+        exit(-1);
+    }
+
+    // replay the greedy bit-plane selection (GreedyBasedSizeInterpreter) from scratch over all bitplanes
+    template<class ErrorEstimator>
+    RateDistortionIndex build_rate_distortion_index(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, const ErrorEstimator& error_estimator){
+        struct StepGain{
+            double unit_error_gain;
+            int level;
+            bool operator<(const StepGain& other) const {
+                return unit_error_gain < other.unit_error_gain;
+            }
+        };
+        const int num_levels = level_sizes.size();
+        std::vector<uint8_t> index(num_levels, 0);
+        RateDistortionIndex rd_index;
+        rd_index.estimator_kind = estimator_kind(&error_estimator);
+        for(int i=0; i<num_levels; i++){
+            rd_index.estimator_scales.push_back(error_estimator.estimate_error(1, i));
+        }
+        double accumulated_error = 0;
+        for(int i=0; i<num_levels; i++){
+            accumulated_error += error_estimator.estimate_error(level_errors[i][0], i);
+        }
+        std::priority_queue<StepGain> heap;
+        for(int i=0; i<num_levels; i++){
+            if(level_sizes[i].empty()) continue;
+            double error_gain = error_estimator.estimate_error_gain(accumulated_error, level_errors[i][0], level_errors[i][1], i);
+            heap.push({error_gain / level_sizes[i][0], i});
+        }
+        uint64_t accumulated_size = 0;
+        rd_index.sizes.push_back(accumulated_size);
+        rd_index.errors.push_back(accumulated_error);
+        while(!heap.empty()){
+            int i = heap.top().level;
+            heap.pop();
+            int j = index[i];
+            accumulated_size += level_sizes[i][j];
+            accumulated_error -= error_estimator.estimate_error(level_errors[i][j], i);
+            accumulated_error += error_estimator.estimate_error(level_errors[i][j + 1], i);
+            rd_index.order.push_back(i);
+            rd_index.sizes.push_back(accumulated_size);
+            // keep the curve monotone: the first step below a tolerance is unchanged
+            rd_index.errors.push_back(std::min(accumulated_error, rd_index.errors.back()));
+            index[i] ++;
+            if(index[i] != level_sizes[i].size()){
+                double error_gain = error_estimator.estimate_error_gain(accumulated_error, level_errors[i][index[i]], level_errors[i][index[i] + 1], i);
+                heap.push({error_gain / level_sizes[i][index[i]], i});
+            }
+        }
+        return rd_index;
+    }
+}
+#endif
@@ -0,0 +1,54 @@
+#ifndef _MDR_RATE_DISTORTION_SIZE_INTERPRETER_HPP
+#define _MDR_RATE_DISTORTION_SIZE_INTERPRETER_HPP
+
+#include "SizeInterpreterInterface.hpp"
+#include "RateDistortionIndex.hpp"
+
+namespace MDR {
+    // greedy bit-plane retrieval answered by binary search over the precomputed rate-distortion index
+    // the index is loaded from metadata, or built on the first query if the data was refactored without one
+    // or with another error estimator
+    template<class ErrorEstimator>
+    class RateDistortionSizeInterpreter : public concepts::SizeInterpreterInterface {
+    public:
+        RateDistortionSizeInterpreter(const ErrorEstimator& e){
+            error_estimator = e;
+        }
+        std::vector<uint64_t> interpret_retrieve_size(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const {
+            if(rd_index.empty()) rd_index = build_rate_distortion_index(level_sizes, level_errors, error_estimator);
+            uint32_t target = rd_index.locate_tolerance(tolerance);
+            auto retrieve_sizes = rd_index.retrieve_sizes(level_sizes, target, index);
+            if(!quiet) std::cout << "Requested tolerance = " << tolerance << ", estimated error = " << rd_index.errors[target] << std::endl;
+            return retrieve_sizes;
+        }
+        // retrieve sizes such that the total retrieved size (including previous retrievals) stays within budget
+        std::vector<uint64_t> interpret_retrieve_size_by_budget(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, uint64_t budget, std::vector<uint8_t>& index) const {
+            if(rd_index.empty()) rd_index = build_rate_distortion_index(level_sizes, level_errors, error_estimator);
+            uint64_t retrieved_size = 0;
+            for(int i=0; i<level_sizes.size(); i++){
+                for(int j=0; j<index[i] && j<level_sizes[i].size(); j++){
+                    retrieved_size += level_sizes[i][j];
+                }
+            }
+            uint64_t remaining_size = (budget > retrieved_size) ? budget - retrieved_size : 0;
+            auto retrieve_sizes = rd_index.retrieve_sizes(level_sizes, rd_index.num_steps(), index, remaining_size);
+            if(!quiet) std::cout << "Requested budget = " << budget << ", estimated error = " << rd_index.errors[rd_index.locate_budget(budget)] << std::endl;
+            return retrieve_sizes;
+        }
+        void load_rate_distortion_index(const RateDistortionIndex& index){
+            if(!index.built_by(error_estimator)){
+                std::cerr << "RateDistortionSizeInterpreter: the stored rate-distortion index was built by another error estimator, it is rebuilt on the first query" << std::endl;
+                rd_index = RateDistortionIndex();
+                return;
+            }
+            rd_index = index;
+        }
+        void print() const {
+            std::cout << "Rate-distortion index based size interpreter." << std::endl;
+        }
+    private:
+        ErrorEstimator error_estimator;
+        mutable RateDistortionIndex rd_index;
+    };
+}
+#endif
@@ -3,5 +3,8 @@
 
 #include "BasicSizeInterpreter.hpp"
 #include "GreedyBasedSizeInterpreter.hpp"
+#include "RateDistortionSizeInterpreter.hpp"
+#include "BudgetSizeInterpreter.hpp"
+#include "OptimalSizeInterpreter.hpp"
 
 #endif
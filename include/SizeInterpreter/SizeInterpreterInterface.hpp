@@ -2,6 +2,8 @@
 #define _MDR_SIZE_INTERPRETER_INTERFACE_HPP
 
 namespace MDR {
+    struct RateDistortionIndex;
+
     namespace concepts {
 
         // level bit-plane reorganizer: EBCOT-like algorithm for multilevel bit-plane truncation
@@ -10,9 +12,22 @@ namespace MDR {
 
             virtual ~SizeInterpreterInterface() = default;
 
-            virtual std::vector<uint32_t> interpret_retrieve_size(const std::vector<std::vector<uint32_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const = 0;
+            virtual std::vector<uint64_t> interpret_retrieve_size(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const = 0;
+
+            // precomputed retrieval order stored in metadata; interpreters that do not use it ignore it
+            virtual void load_rate_distortion_index(const RateDistortionIndex& rd_index) {}
+
+            // measured retrieval of the last request, for interpreters that adapt to I/O throughput
+            virtual void record_retrieval(uint64_t retrieved_size, double seconds) {}
+
+            // requests are reported on stdout unless quiet, e.g. while interpreting a speculative request
+            void set_quiet(bool q){
+                quiet = q;
+            }
 
             virtual void print() const = 0;
+        protected:
+            bool quiet = false;
         };
     }
 }
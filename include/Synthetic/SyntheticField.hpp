@@ -0,0 +1,256 @@
+#ifndef _MDR_SYNTHETIC_FIELD_HPP
+#define _MDR_SYNTHETIC_FIELD_HPP
+
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <future>
+#include <algorithm>
+#include "ThreadPool.hpp"
+
+namespace MDR {
+    // Deterministic synthetic fields for benchmarks without external data
+    // fields are defined on the periodic unit cube sampled at dims points per dimension (dims[0] is the slowest),
+    // values only depend on the seed and the dimensions, not on the number of threads
+
+    // counter-based random numbers so that any point can be generated independently
+    inline uint64_t splitmix64(uint64_t x){
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+    inline double hash_uniform(uint64_t seed, uint64_t index){
+        return (splitmix64(splitmix64(seed) ^ index) >> 11) * (1.0 / 9007199254740992.0);
+    }
+    inline double hash_normal(uint64_t seed, uint64_t index){
+        double u1 = hash_uniform(seed, 2 * index);
+        double u2 = hash_uniform(seed, 2 * index + 1);
+        return sqrt(-2 * log(1 - u1)) * cos(2 * M_PI * u2);
+    }
+
+    // run f(row, slow_coords, row_data) on every row along the fastest dimension, rows are split over the threads
+    template <class T, class Func>
+    void for_each_field_row(T * data, const std::vector<uint32_t>& dims, int num_threads, Func f){
+        const int num_dims = dims.size();
+        const uint64_t row_size = dims.back();
+        uint64_t num_rows = 1;
+        for(int i=0; i<num_dims-1; i++) num_rows *= dims[i];
+        auto run_rows = [&](uint64_t begin, uint64_t end){
+            std::vector<double> x(num_dims, 0);
+            for(uint64_t r=begin; r<end; r++){
+                uint64_t index = r;
+                for(int k=num_dims-2; k>=0; k--){
+                    x[k] = (index % dims[k]) * 1.0 / dims[k];
+                    index /= dims[k];
+                }
+                f(r, x, data + r * row_size);
+            }
+        };
+        if(num_threads <= 1 || num_rows == 1){
+            run_rows(0, num_rows);
+            return;
+        }
+        ThreadPool pool(num_threads);
+        const uint64_t num_chunks = std::min<uint64_t>(num_rows, 8 * (uint64_t) num_threads);
+        std::vector<std::future<void>> tasks;
+        for(uint64_t c=0; c<num_chunks; c++){
+            uint64_t begin = num_rows * c / num_chunks;
+            uint64_t end = num_rows * (c + 1) / num_chunks;
+            tasks.push_back(pool.submit([&run_rows, begin, end](){ run_rows(begin, end); }));
+        }
+        for(auto& t:tasks) t.get();
+    }
+
+    // Gaussian random field with power spectrum P(k) ~ k^(-spectral_slope), normalized to unit variance
+    // synthesized as a sum of random Fourier modes with wavenumbers log-uniform in [1, k_max]: larger slopes give smoother fields
+    class GaussianRandomField {
+    public:
+        GaussianRandomField(double spectral_slope = 3, uint32_t num_modes = 256, double k_max = 64, uint64_t seed = 0)
+            : spectral_slope(spectral_slope), num_modes(num_modes), k_max(k_max), seed(seed) {}
+        virtual ~GaussianRandomField() = default;
+
+        template <class T>
+        void generate(T * data, const std::vector<uint32_t>& dims, int num_threads = std::thread::hardware_concurrency()) const {
+            const int num_dims = dims.size();
+            std::vector<Mode> modes = sample_modes(num_dims);
+            const uint32_t row_size = dims.back();
+            for_each_field_row(data, dims, num_threads, [&](uint64_t r, const std::vector<double>& x, T * row){
+                std::vector<double> values(row_size, 0);
+                for(const auto& m:modes){
+                    double phase = m.phase;
+                    for(int k=0; k<num_dims-1; k++) phase += 2 * M_PI * m.k[k] * x[k];
+                    // advance the phase along the row by rotation
+                    const double delta = 2 * M_PI * m.k[num_dims - 1] / row_size;
+                    const double cd = cos(delta), sd = sin(delta);
+                    double c = cos(phase), s = sin(phase);
+                    for(uint32_t j=0; j<row_size; j++){
+                        values[j] += m.amplitude * c;
+                        double next_c = c * cd - s * sd;
+                        s = s * cd + c * sd;
+                        c = next_c;
+                    }
+                }
+                for(uint32_t j=0; j<row_size; j++) row[j] = values[j];
+            });
+        }
+
+        template <class T>
+        std::vector<T> generate(const std::vector<uint32_t>& dims, int num_threads = std::thread::hardware_concurrency()) const {
+            size_t num_elements = 1;
+            for(const auto& d:dims) num_elements *= d;
+            std::vector<T> data(num_elements);
+            generate(data.data(), dims, num_threads);
+            return data;
+        }
+    protected:
+        // energy spectrum E(k) = k^(d-1) P(k)
+        virtual double energy(double k, int num_dims) const {
+            return pow(k, num_dims - 1 - spectral_slope);
+        }
+    private:
+        struct Mode{
+            std::vector<double> k;
+            double phase;
+            double amplitude;
+        };
+
+        std::vector<Mode> sample_modes(int num_dims) const {
+            std::mt19937_64 generator(seed);
+            std::uniform_real_distribution<double> uniform(0, 1);
+            std::normal_distribution<double> normal(0, 1);
+            std::vector<Mode> modes(num_modes);
+            double variance = 0;
+            for(auto& m:modes){
+                // random direction, integer wavevector keeps the field periodic
+                double k_norm = exp(log(k_max) * uniform(generator));
+                std::vector<double> direction(num_dims);
+                double norm = 0;
+                for(auto& d:direction){
+                    d = normal(generator);
+                    norm += d * d;
+                }
+                norm = sqrt(norm);
+                m.k = std::vector<double>(num_dims);
+                double k_actual = 0;
+                for(int i=0; i<num_dims; i++){
+                    m.k[i] = round(direction[i] / norm * k_norm);
+                    k_actual += m.k[i] * m.k[i];
+                }
+                k_actual = std::max(1.0, sqrt(k_actual));
+                m.phase = 2 * M_PI * uniform(generator);
+                // log-uniform sampling: weight by dk = k dlog(k)
+                m.amplitude = normal(generator) * sqrt(energy(k_actual, num_dims) * k_actual);
+                variance += m.amplitude * m.amplitude / 2;
+            }
+            double scale = (variance > 0) ? 1.0 / sqrt(variance) : 0;
+            for(auto& m:modes) m.amplitude *= scale;
+            return modes;
+        }
+
+        double spectral_slope;
+        uint32_t num_modes;
+        double k_max;
+        uint64_t seed;
+    };
+
+    // Turbulence-like field: Kolmogorov energy spectrum E(k) ~ k^(-5/3) up to the dissipation wavenumber, Gaussian cut-off beyond
+    class TurbulenceField : public GaussianRandomField {
+    public:
+        TurbulenceField(double k_dissipation = 32, uint32_t num_modes = 512, uint64_t seed = 0)
+            : GaussianRandomField(0, num_modes, 4 * k_dissipation, seed), k_dissipation(k_dissipation) {}
+    protected:
+        double energy(double k, int num_dims) const {
+            return pow(k, -5.0/3) * exp(-(k / k_dissipation) * (k / k_dissipation));
+        }
+    private:
+        double k_dissipation;
+    };
+
+    // Sparse field: a fraction density of the points hold standard normal values, the others are zero
+    class SparseField {
+    public:
+        SparseField(double density = 0.01, uint64_t seed = 0) : density(density), seed(seed) {}
+
+        template <class T>
+        void generate(T * data, const std::vector<uint32_t>& dims, int num_threads = std::thread::hardware_concurrency()) const {
+            const uint32_t row_size = dims.back();
+            for_each_field_row(data, dims, num_threads, [&](uint64_t r, const std::vector<double>& x, T * row){
+                for(uint32_t j=0; j<row_size; j++){
+                    uint64_t index = r * row_size + j;
+                    row[j] = (hash_uniform(seed, index) < density) ? hash_normal(seed + 1, index) : 0;
+                }
+            });
+        }
+
+        template <class T>
+        std::vector<T> generate(const std::vector<uint32_t>& dims, int num_threads = std::thread::hardware_concurrency()) const {
+            size_t num_elements = 1;
+            for(const auto& d:dims) num_elements *= d;
+            std::vector<T> data(num_elements);
+            generate(data.data(), dims, num_threads);
+            return data;
+        }
+    private:
+        double density;
+        uint64_t seed;
+    };
+
+    // Discontinuous field: smooth background with jumps across random planar interfaces (shock-like)
+    class DiscontinuousField {
+    public:
+        DiscontinuousField(uint32_t num_interfaces = 8, double jump = 1, uint64_t seed = 0) : num_interfaces(num_interfaces), jump(jump), seed(seed) {}
+
+        template <class T>
+        void generate(T * data, const std::vector<uint32_t>& dims, int num_threads = std::thread::hardware_concurrency()) const {
+            const int num_dims = dims.size();
+            const uint32_t row_size = dims.back();
+            std::mt19937_64 generator(seed);
+            std::uniform_real_distribution<double> uniform(0, 1);
+            std::normal_distribution<double> normal(0, 1);
+            // interface i: normal n_i, offset c_i, jump height h_i
+            std::vector<std::vector<double>> normals(num_interfaces, std::vector<double>(num_dims));
+            std::vector<double> offsets(num_interfaces), heights(num_interfaces);
+            for(int i=0; i<num_interfaces; i++){
+                double norm = 0;
+                for(auto& n:normals[i]){
+                    n = normal(generator);
+                    norm += n * n;
+                }
+                for(auto& n:normals[i]) n /= sqrt(norm);
+                offsets[i] = 0;
+                for(int k=0; k<num_dims; k++) offsets[i] += normals[i][k] * uniform(generator);
+                heights[i] = jump * normal(generator);
+            }
+            for_each_field_row(data, dims, num_threads, [&](uint64_t r, const std::vector<double>& x_row, T * row){
+                std::vector<double> x(x_row);
+                for(uint32_t j=0; j<row_size; j++){
+                    x[num_dims - 1] = j * 1.0 / row_size;
+                    double value = 1;
+                    for(int k=0; k<num_dims; k++) value *= sin(2 * M_PI * x[k] + 0.3);
+                    for(int i=0; i<num_interfaces; i++){
+                        double distance = -offsets[i];
+                        for(int k=0; k<num_dims; k++) distance += normals[i][k] * x[k];
+                        if(distance > 0) value += heights[i];
+                    }
+                    row[j] = value;
+                }
+            });
+        }
+
+        template <class T>
+        std::vector<T> generate(const std::vector<uint32_t>& dims, int num_threads = std::thread::hardware_concurrency()) const {
+            size_t num_elements = 1;
+            for(const auto& d:dims) num_elements *= d;
+            std::vector<T> data(num_elements);
+            generate(data.data(), dims, num_threads);
+            return data;
+        }
+    private:
+        uint32_t num_interfaces;
+        double jump;
+        uint64_t seed;
+    };
+}
+#endif
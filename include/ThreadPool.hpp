@@ -0,0 +1,135 @@
+#ifndef _MDR_THREAD_POOL_HPP
+#define _MDR_THREAD_POOL_HPP
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <atomic>
+#include "Allocator/Allocator.hpp"
+
+namespace MDR {
+    // Work-stealing thread pool
+    // each worker owns a task deque: it runs its own tasks first-in-first-out and steals from the back of other deques when idle
+    // tasks submitted from a worker go to that worker's deque, others are distributed round-robin
+    // a task runs with the allocator installed on the submitting thread, which must outlive the task
+    class ThreadPool {
+    public:
+        ThreadPool(int num_threads = std::thread::hardware_concurrency()){
+            if(num_threads < 1) num_threads = 1;
+            for(int i=0; i<num_threads; i++){
+                queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+            }
+            for(int i=0; i<num_threads; i++){
+                workers.push_back(std::thread(&ThreadPool::worker, this, i));
+            }
+        }
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        template<class F>
+        std::future<typename std::result_of<F()>::type> submit(F f){
+            typedef typename std::result_of<F()>::type R;
+            auto task = std::make_shared<std::packaged_task<R()>>(f);
+            std::future<R> result = task->get_future();
+            concepts::AllocatorInterface * allocator = current_allocator();
+            int id = (local_pool() == this) ? local_index() : (next_queue ++) % queues.size();
+            {
+                std::lock_guard<std::mutex> lock(queues[id]->mutex);
+                queues[id]->tasks.push_back([task, allocator](){
+                    AllocatorScope allocator_scope(allocator);
+                    (*task)();
+                });
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                num_queued ++;
+            }
+            cv.notify_one();
+            return result;
+        }
+
+        int size() const {
+            return workers.size();
+        }
+
+        // queued tasks are finished before the workers exit
+        ~ThreadPool(){
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stop = true;
+            }
+            cv.notify_all();
+            for(auto& w:workers) w.join();
+        }
+    private:
+        struct WorkQueue{
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        static ThreadPool *& local_pool(){
+            static thread_local ThreadPool * pool = NULL;
+            return pool;
+        }
+        static int& local_index(){
+            static thread_local int index = 0;
+            return index;
+        }
+
+        void worker(int id){
+            local_pool() = this;
+            local_index() = id;
+            while(true){
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cv.wait(lock, [this](){ return stop || (num_queued > 0); });
+                    if(stop && (num_queued <= 0)) return;
+                }
+                std::function<void()> task;
+                if(pop_task(id, task)){
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        num_queued --;
+                    }
+                    task();
+                }
+            }
+        }
+
+        bool pop_task(int id, std::function<void()>& task){
+            {
+                std::lock_guard<std::mutex> lock(queues[id]->mutex);
+                if(!queues[id]->tasks.empty()){
+                    task = std::move(queues[id]->tasks.front());
+                    queues[id]->tasks.pop_front();
+                    return true;
+                }
+            }
+            for(int i=1; i<queues.size(); i++){
+                WorkQueue& victim = *queues[(id + i) % queues.size()];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if(!victim.tasks.empty()){
+                    task = std::move(victim.tasks.back());
+                    victim.tasks.pop_back();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        std::vector<std::unique_ptr<WorkQueue>> queues;
+        std::vector<std::thread> workers;
+        std::mutex mutex;
+        std::condition_variable cv;
+        // tasks pushed but not yet taken
+        int64_t num_queued = 0;
+        bool stop = false;
+        std::atomic<uint32_t> next_queue{0};
+    };
+}
+#endif
@@ -0,0 +1,198 @@
+#ifndef _MDR_BATCH_CONTAINER_WRITER_HPP
+#define _MDR_BATCH_CONTAINER_WRITER_HPP
+
+#include "WriterInterface.hpp"
+#include "RefactorUtils.hpp"
+#include <memory>
+#include <mutex>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace MDR {
+    // Batch container shared by the writers of all variables
+    // regions are reserved under a lock and written with pwrite, so variables can be written concurrently
+    class BatchContainerFile {
+    public:
+        BatchContainerFile(const std::string& container_file, uint64_t alignment = 4096) : container_file(container_file), alignment(alignment) {
+            fd = open(container_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if(fd < 0){
+                std::cerr << "Errors in open while writing to " << container_file << std::endl;
+                exit(-1);
+            }
+        }
+        BatchContainerFile(const BatchContainerFile&) = delete;
+        BatchContainerFile& operator=(const BatchContainerFile&) = delete;
+
+        // register a variable, return its position in the variable index
+        // names identify variables when reading back, so they must be unique
+        int add_variable(const std::string& name){
+            std::lock_guard<std::mutex> lock(mutex);
+            for(const auto& v:variables){
+                if(v.name == name){
+                    std::cerr << "Variable " << name << " is already in " << container_file << std::endl;
+                    exit(-1);
+                }
+            }
+            variables.push_back(VariableEntry());
+            variables.back().name = name;
+            return variables.size() - 1;
+        }
+
+        // reserve an aligned region of the given size, return its offset
+        uint64_t reserve(uint64_t size){
+            std::lock_guard<std::mutex> lock(mutex);
+            uint64_t offset = (end_offset + alignment - 1) / alignment * alignment;
+            end_offset = offset + size;
+            return offset;
+        }
+
+        bool write(uint8_t const * data, uint64_t size, uint64_t offset) const {
+            while(size > 0){
+                ssize_t count = pwrite(fd, data, size, offset);
+                if(count <= 0){
+                    std::cerr << "Errors in pwrite while writing to " << container_file << std::endl;
+                    return false;
+                }
+                data += count;
+                size -= count;
+                offset += count;
+            }
+            return true;
+        }
+
+        bool write(const std::vector<uint8_t*>& buffers, const std::vector<uint64_t>& sizes, uint64_t offset) const {
+            if(!pwritev_all(fd, buffers, sizes, offset)){
+                std::cerr << "Errors in pwritev while writing to " << container_file << std::endl;
+                return false;
+            }
+            return true;
+        }
+
+        void set_levels(int id, const std::vector<std::vector<uint64_t>>& level_offsets, const std::vector<std::vector<uint64_t>>& level_sizes){
+            std::lock_guard<std::mutex> lock(mutex);
+            variables[id].level_offsets = level_offsets;
+            variables[id].level_sizes = level_sizes;
+        }
+
+        void set_metadata(int id, uint64_t offset, uint64_t size){
+            std::lock_guard<std::mutex> lock(mutex);
+            variables[id].metadata_offset = offset;
+            variables[id].metadata_size = size;
+        }
+
+        // append the variable index and trailer, called once all variables are written
+        void finalize(){
+            std::lock_guard<std::mutex> lock(mutex);
+            std::vector<uint8_t> index;
+            for(const auto& v:variables){
+                append(index, (uint32_t) v.name.size());
+                index.insert(index.end(), v.name.begin(), v.name.end());
+                append(index, v.metadata_offset);
+                append(index, v.metadata_size);
+                append(index, (uint32_t) v.level_offsets.size());
+                for(int i=0; i<v.level_offsets.size(); i++){
+                    append(index, (uint32_t) v.level_offsets[i].size());
+                    for(int j=0; j<v.level_offsets[i].size(); j++){
+                        append(index, v.level_offsets[i][j]);
+                        append(index, v.level_sizes[i][j]);
+                    }
+                }
+            }
+            BatchContainerTrailer trailer;
+            trailer.index_offset = end_offset;
+            trailer.index_size = index.size();
+            trailer.num_variables = variables.size();
+            trailer.magic = MDR_BATCH_CONTAINER_MAGIC;
+            write(index.data(), index.size(), trailer.index_offset);
+            write(reinterpret_cast<uint8_t const *>(&trailer), sizeof(BatchContainerTrailer), trailer.index_offset + trailer.index_size);
+            end_offset = trailer.index_offset + trailer.index_size + sizeof(BatchContainerTrailer);
+        }
+
+        ~BatchContainerFile(){
+            if(fd >= 0) close(fd);
+        }
+    private:
+        struct VariableEntry{
+            std::string name;
+            uint64_t metadata_offset = 0;
+            uint64_t metadata_size = 0;
+            std::vector<std::vector<uint64_t>> level_offsets;
+            std::vector<std::vector<uint64_t>> level_sizes;
+        };
+
+        template <class T>
+        static void append(std::vector<uint8_t>& buffer, T value){
+            uint8_t const * value_pos = reinterpret_cast<uint8_t const *>(&value);
+            buffer.insert(buffer.end(), value_pos, value_pos + sizeof(T));
+        }
+
+        std::string container_file;
+        uint64_t alignment;
+        int fd = -1;
+        std::mutex mutex;
+        uint64_t end_offset = 0;
+        std::vector<VariableEntry> variables;
+    };
+
+    // A writer for one variable of a batch container
+    class BatchVariableWriter : public concepts::WriterInterface {
+    public:
+        BatchVariableWriter(std::shared_ptr<BatchContainerFile> container, const std::string& name) : container(container) {
+            id = container->add_variable(name);
+        }
+
+        std::vector<uint32_t> write_level_components(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint64_t>>& level_sizes) const {
+            std::vector<uint32_t> level_num;
+            for(int i=0; i<level_components.size(); i++){
+                level_num.push_back(write_level_component(i, level_components[i], level_sizes[i]));
+            }
+            return level_num;
+        }
+
+        bool streaming() const {
+            return true;
+        }
+
+        // each level goes to its own region, the layout is registered with the metadata
+        uint32_t write_level_component(int level, const std::vector<uint8_t*>& level_component, const std::vector<uint64_t>& level_sizes) const {
+            if(level == 0){
+                level_offsets.clear();
+                level_bitplane_sizes.clear();
+            }
+            uint64_t level_size = 0;
+            for(int j=0; j<level_sizes.size(); j++){
+                level_size += level_sizes[j];
+            }
+            uint64_t offset = container->reserve(level_size);
+            bool success = container->write(level_component, level_sizes, offset);
+            std::vector<uint64_t> bitplane_offsets;
+            for(int j=0; j<level_sizes.size(); j++){
+                bitplane_offsets.push_back(offset);
+                offset += level_sizes[j];
+            }
+            level_offsets.push_back(bitplane_offsets);
+            level_bitplane_sizes.push_back(level_sizes);
+            return success ? 1 : 0;
+        }
+
+        void write_metadata(uint8_t const * metadata, uint64_t size) const {
+            container->set_levels(id, level_offsets, level_bitplane_sizes);
+            uint64_t offset = container->reserve(size);
+            if(!container->write(metadata, size, offset)) return;
+            container->set_metadata(id, offset, size);
+        }
+
+        ~BatchVariableWriter(){}
+
+        void print() const {
+            std::cout << "Batch container variable writer." << std::endl;
+        }
+    private:
+        std::shared_ptr<BatchContainerFile> container;
+        int id;
+        // layout recorded while writing levels, registered with the metadata
+        mutable std::vector<std::vector<uint64_t>> level_offsets;
+        mutable std::vector<std::vector<uint64_t>> level_bitplane_sizes;
+    };
+}
+#endif
@@ -0,0 +1,118 @@
+#ifndef _MDR_CONTAINER_FILE_WRITER_HPP
+#define _MDR_CONTAINER_FILE_WRITER_HPP
+
+#include "WriterInterface.hpp"
+#include "RefactorUtils.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace MDR {
+    // A writer that writes all levels and the metadata into one container file with a footer index
+    class ContainerFileWriter : public concepts::WriterInterface {
+    public:
+        ContainerFileWriter(const std::string& container_file, uint64_t alignment = 1 << 20) : container_file(container_file), alignment(alignment) {}
+
+        std::vector<uint32_t> write_level_components(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint64_t>>& level_sizes) const {
+            std::vector<uint32_t> level_num;
+            for(int i=0; i<level_components.size(); i++){
+                level_num.push_back(write_level_component(i, level_components[i], level_sizes[i]));
+            }
+            return level_num;
+        }
+
+        bool streaming() const {
+            return true;
+        }
+
+        // levels are appended in order, level 0 starts a new container
+        uint32_t write_level_component(int level, const std::vector<uint8_t*>& level_component, const std::vector<uint64_t>& level_sizes) const {
+            int fd = open(container_file.c_str(), O_WRONLY | O_CREAT | ((level == 0) ? O_TRUNC : 0), 0644);
+            if(fd < 0){
+                std::cerr << "Errors in open while writing to " << container_file << std::endl;
+                return 0;
+            }
+            if(level == 0){
+                level_offsets.clear();
+                level_bitplane_sizes.clear();
+                data_size = 0;
+            }
+            // align level to stripe boundary, the gap is left as a hole
+            uint64_t offset = (data_size + alignment - 1) / alignment * alignment;
+            level_offsets.push_back(offset);
+            level_bitplane_sizes.push_back(level_sizes);
+            bool success = pwritev_all(fd, level_component, level_sizes, offset);
+            if(!success){
+                std::cerr << "Errors in pwritev while writing to " << container_file << std::endl;
+            }
+            for(int j=0; j<level_sizes.size(); j++){
+                offset += level_sizes[j];
+            }
+            data_size = offset;
+            close(fd);
+            return success ? 1 : 0;
+        }
+
+        // append metadata, index and trailer after the level data
+        void write_metadata(uint8_t const * metadata, uint64_t size) const {
+            int fd = open(container_file.c_str(), O_WRONLY | O_CREAT, 0644);
+            if(fd < 0){
+                std::cerr << "Errors in open while writing to " << container_file << std::endl;
+                return;
+            }
+            ContainerTrailer trailer;
+            trailer.metadata_offset = data_size;
+            trailer.metadata_size = size;
+            write_all(fd, metadata, size, trailer.metadata_offset);
+            std::vector<uint8_t> index;
+            for(int i=0; i<level_offsets.size(); i++){
+                append(index, (uint32_t) level_bitplane_sizes[i].size());
+                uint64_t offset = level_offsets[i];
+                for(int j=0; j<level_bitplane_sizes[i].size(); j++){
+                    append(index, offset);
+                    append(index, level_bitplane_sizes[i][j]);
+                    offset += level_bitplane_sizes[i][j];
+                }
+            }
+            trailer.index_offset = trailer.metadata_offset + trailer.metadata_size;
+            trailer.index_size = index.size();
+            trailer.num_levels = level_offsets.size();
+            trailer.magic = MDR_CONTAINER_MAGIC;
+            write_all(fd, index.data(), index.size(), trailer.index_offset);
+            write_all(fd, reinterpret_cast<uint8_t const *>(&trailer), sizeof(ContainerTrailer), trailer.index_offset + trailer.index_size);
+            close(fd);
+        }
+
+        ~ContainerFileWriter(){}
+
+        void print() const {
+            std::cout << "Container file writer." << std::endl;
+        }
+    private:
+        template <class T>
+        static void append(std::vector<uint8_t>& buffer, T value){
+            uint8_t const * value_pos = reinterpret_cast<uint8_t const *>(&value);
+            buffer.insert(buffer.end(), value_pos, value_pos + sizeof(T));
+        }
+
+        void write_all(int fd, uint8_t const * data, uint64_t size, uint64_t offset) const {
+            while(size > 0){
+                ssize_t count = pwrite(fd, data, size, offset);
+                if(count <= 0){
+                    std::cerr << "Errors in pwrite while writing to " << container_file << std::endl;
+                    return;
+                }
+                data += count;
+                size -= count;
+                offset += count;
+            }
+        }
+
+        std::string container_file;
+        uint64_t alignment;
+        // layout recorded while writing levels, emitted with the metadata
+        mutable uint64_t data_size = 0;
+        mutable std::vector<uint64_t> level_offsets;
+        mutable std::vector<std::vector<uint64_t>> level_bitplane_sizes;
+    };
+}
+#endif
@@ -2,7 +2,9 @@
 #define _MDR_FILE_WRITER_HPP
 
 #include "WriterInterface.hpp"
+#include "RefactorUtils.hpp"
 #include <cstdio>
+#include <fcntl.h>
 
 namespace MDR {
     // A writer that writes the concatenated level components
@@ -10,29 +12,35 @@ namespace MDR {
     public:
         ConcatLevelFileWriter(const std::string& metadata_file, const std::vector<std::string>& level_files) : metadata_file(metadata_file), level_files(level_files) {}
 
-        std::vector<uint32_t> write_level_components(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint32_t>>& level_sizes) const {
+        std::vector<uint32_t> write_level_components(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint64_t>>& level_sizes) const {
             std::vector<uint32_t> level_num;
             for(int i=0; i<level_components.size(); i++){
-                uint32_t concated_level_size = 0;
-                for(int j=0; j<level_components[i].size(); j++){
-                    concated_level_size += level_sizes[i][j];
-                }
-                uint8_t * concated_level_data = (uint8_t *) malloc(concated_level_size);
-                uint8_t * concated_level_data_pos = concated_level_data;
-                for(int j=0; j<level_components[i].size(); j++){
-                    memcpy(concated_level_data_pos, level_components[i][j], level_sizes[i][j]);
-                    concated_level_data_pos += level_sizes[i][j];
-                }
-                FILE * file = fopen((level_files[i]).c_str(), "w");
-                fwrite(concated_level_data, 1, concated_level_size, file);
-                fclose(file);
-                free(concated_level_data);
-                level_num.push_back(1);
+                level_num.push_back(write_level_component(i, level_components[i], level_sizes[i]));
             }
             return level_num;
         }
 
-        void write_metadata(uint8_t const * metadata, uint32_t size) const {
+        bool streaming() const {
+            return true;
+        }
+
+        // the bitplanes are written straight from the encoder buffers, without a concatenated copy
+        uint32_t write_level_component(int level, const std::vector<uint8_t*>& level_component, const std::vector<uint64_t>& level_sizes) const {
+            int fd = open(level_files[level].c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if(fd < 0){
+                std::cerr << "Errors in open while writing to " << level_files[level] << std::endl;
+                return 0;
+            }
+            if(!pwritev_all(fd, level_component, level_sizes, 0)){
+                std::cerr << "Errors in pwritev while writing to " << level_files[level] << std::endl;
+                close(fd);
+                return 0;
+            }
+            close(fd);
+            return 1;
+        }
+
+        void write_metadata(uint8_t const * metadata, uint64_t size) const {
             FILE * file = fopen(metadata_file.c_str(), "w");
             fwrite(metadata, 1, size, file);
             fclose(file);
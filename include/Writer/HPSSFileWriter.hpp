@@ -2,48 +2,99 @@
 #define _MDR_HPSS_WRITER_HPP
 
 #include "WriterInterface.hpp"
+#include "RefactorUtils.hpp"
+#include "ThreadPool.hpp"
 #include <cstdio>
+#include <memory>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace MDR {
-    // A writer that writes the concatenated level components
-    // Merge multiple components if size is small
+    // A writer that packs the concatenated level components into fixed-size segments for archival storage
+    // segments are written concurrently, the segment map is appended to the metadata
     class HPSSFileWriter : public concepts::WriterInterface {
     public:
-        HPSSFileWriter(const std::string& metadata_file, const std::vector<std::string>& level_files, int num_process, int min_HPSS_size) : metadata_file(metadata_file), level_files(level_files), min_size((min_HPSS_size - 1)/num_process + 1) {}
+        HPSSFileWriter(const std::string& metadata_file, const std::vector<std::string>& level_files, int num_process, uint64_t min_HPSS_size, int num_threads = 8)
+            : metadata_file(metadata_file), level_files(level_files), segment_size((min_HPSS_size - 1)/num_process + 1), pool(std::make_shared<ThreadPool>(num_threads)) {}
 
-        std::vector<uint32_t> write_level_components(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint32_t>>& level_sizes) const {
+        std::vector<uint32_t> write_level_components(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint64_t>>& level_sizes) const {
             std::vector<uint32_t> level_num;
             for(int i=0; i<level_components.size(); i++){
-                uint32_t concated_level_size = 0;
-                uint32_t prev_index = 0;
-                uint32_t count = 0;
-                for(int j=0; j<level_components[i].size(); j++){
-                    concated_level_size += level_sizes[i][j];
-                    if((concated_level_size >= min_size) || (j == level_components[i].size() - 1)){
-                        // TODO: deal with the last file that may not be larger than min_size
-                        uint8_t * concated_level_data = (uint8_t *) malloc(concated_level_size);
-                        uint8_t * concated_level_data_pos = concated_level_data;
-                        std::cout << +prev_index << " " << j << " " << concated_level_size << std::endl;
-                        for(int k=prev_index + 1; k<=j; k++){
-                            memcpy(concated_level_data_pos, level_components[i][k], level_sizes[i][k]);
-                            concated_level_data_pos += level_sizes[i][k];
-                        }
-                        FILE * file = fopen((level_files[i] + "_" + std::to_string(count)).c_str(), "w");
-                        fwrite(concated_level_data, 1, concated_level_size, file);
-                        fclose(file);
-                        free(concated_level_data);
-                        count ++;
-                        concated_level_size = 0;
-                        prev_index = j;
+                level_num.push_back(write_level_component(i, level_components[i], level_sizes[i]));
+            }
+            return level_num;
+        }
+
+        bool streaming() const {
+            return true;
+        }
+
+        // cut the level into segments, bitplanes may span two segments; return the number of segments
+        uint32_t write_level_component(int level, const std::vector<uint8_t*>& level_component, const std::vector<uint64_t>& level_sizes) const {
+            if(level == 0) level_byte_sizes.clear();
+            std::vector<std::vector<uint8_t*>> segment_buffers(1);
+            std::vector<std::vector<uint64_t>> segment_sizes(1);
+            uint64_t level_size = 0;
+            uint64_t segment_remaining = segment_size;
+            for(int j=0; j<level_component.size(); j++){
+                uint8_t * pos = level_component[j];
+                uint64_t remaining = level_sizes[j];
+                level_size += remaining;
+                while(remaining > 0){
+                    if(segment_remaining == 0){
+                        segment_buffers.push_back(std::vector<uint8_t*>());
+                        segment_sizes.push_back(std::vector<uint64_t>());
+                        segment_remaining = segment_size;
                     }
+                    uint64_t size = std::min(remaining, segment_remaining);
+                    segment_buffers.back().push_back(pos);
+                    segment_sizes.back().push_back(size);
+                    pos += size;
+                    remaining -= size;
+                    segment_remaining -= size;
                 }
             }
-            return level_num;
+            level_byte_sizes.push_back(level_size);
+            if(level_size == 0) return 0;
+            std::vector<std::future<bool>> tasks;
+            for(int k=0; k<segment_buffers.size(); k++){
+                std::string filename = segment_name(level_files[level], k);
+                const std::vector<uint8_t*>& buffers = segment_buffers[k];
+                const std::vector<uint64_t>& sizes = segment_sizes[k];
+                tasks.push_back(pool->submit([filename, &buffers, &sizes](){
+                    int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+                    if(fd < 0){
+                        std::cerr << "Errors in open while writing to " << filename << std::endl;
+                        return false;
+                    }
+                    bool success = pwritev_all(fd, buffers, sizes, 0);
+                    if(!success){
+                        std::cerr << "Errors in pwritev while writing to " << filename << std::endl;
+                    }
+                    close(fd);
+                    return success;
+                }));
+            }
+            bool success = true;
+            for(auto& t:tasks) success = t.get() && success;
+            return success ? segment_buffers.size() : 0;
         }
 
-        void write_metadata(uint8_t const * metadata, uint32_t size) const {
+        // metadata followed by the segment map
+        void write_metadata(uint8_t const * metadata, uint64_t size) const {
+            HPSSSegmentTrailer trailer;
+            trailer.metadata_size = size;
+            trailer.segment_size = segment_size;
+            trailer.num_levels = level_byte_sizes.size();
+            trailer.magic = MDR_HPSS_SEGMENT_MAGIC;
             FILE * file = fopen(metadata_file.c_str(), "w");
+            if(file == NULL){
+                std::cerr << "Errors in open while writing to " << metadata_file << std::endl;
+                return;
+            }
             fwrite(metadata, 1, size, file);
+            fwrite(level_byte_sizes.data(), sizeof(uint64_t), level_byte_sizes.size(), file);
+            fwrite(&trailer, sizeof(HPSSSegmentTrailer), 1, file);
             fclose(file);
         }
 
@@ -53,9 +104,11 @@ namespace MDR {
             std::cout << "HPSS file writer." << std::endl;
         }
     private:
-        uint32_t min_size = 0;
-        std::vector<std::string> level_files;
         std::string metadata_file;
+        std::vector<std::string> level_files;
+        uint64_t segment_size = 0;
+        std::shared_ptr<ThreadPool> pool;
+        mutable std::vector<uint64_t> level_byte_sizes;
     };
 }
 #endif
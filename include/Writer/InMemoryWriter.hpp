@@ -0,0 +1,58 @@
+#ifndef _MDR_IN_MEMORY_WRITER_HPP
+#define _MDR_IN_MEMORY_WRITER_HPP
+
+#include "WriterInterface.hpp"
+#include "InMemoryStore.hpp"
+#include <memory>
+#include <cstring>
+
+namespace MDR {
+    // A writer that appends the level components to an in-memory store, without any I/O
+    class InMemoryWriter : public concepts::WriterInterface {
+    public:
+        InMemoryWriter(std::shared_ptr<InMemoryStore> store) : store(store) {}
+
+        std::vector<uint32_t> write_level_components(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint64_t>>& level_sizes) const {
+            std::vector<uint32_t> level_num;
+            for(int i=0; i<level_components.size(); i++){
+                level_num.push_back(write_level_component(i, level_components[i], level_sizes[i]));
+            }
+            return level_num;
+        }
+
+        bool streaming() const {
+            return true;
+        }
+
+        // level 0 starts a new refactor and clears the store
+        uint32_t write_level_component(int level, const std::vector<uint8_t*>& level_component, const std::vector<uint64_t>& level_sizes) const {
+            uint64_t level_size = 0;
+            for(int j=0; j<level_sizes.size(); j++){
+                level_size += level_sizes[j];
+            }
+            std::lock_guard<std::mutex> lock(store->mutex);
+            if(level == 0) store->levels.clear();
+            store->levels.push_back(std::vector<uint8_t>(level_size));
+            uint8_t * pos = store->levels.back().data();
+            for(int j=0; j<level_component.size(); j++){
+                memcpy(pos, level_component[j], level_sizes[j]);
+                pos += level_sizes[j];
+            }
+            return 1;
+        }
+
+        void write_metadata(uint8_t const * metadata, uint64_t size) const {
+            std::lock_guard<std::mutex> lock(store->mutex);
+            store->metadata = std::vector<uint8_t>(metadata, metadata + size);
+        }
+
+        ~InMemoryWriter(){}
+
+        void print() const {
+            std::cout << "In-memory writer." << std::endl;
+        }
+    private:
+        std::shared_ptr<InMemoryStore> store;
+    };
+}
+#endif
@@ -0,0 +1,83 @@
+#ifndef _MDR_REORGANIZED_FILE_WRITER_HPP
+#define _MDR_REORGANIZED_FILE_WRITER_HPP
+
+#include "WriterInterface.hpp"
+#include "RefactorUtils.hpp"
+#include "Reorganizer/Reorganizer.hpp"
+#include "Allocator/Allocator.hpp"
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace MDR {
+    // A writer that places the bitplanes of all levels in one data file, in the order chosen by the reorganizer
+    // the order table is appended to the metadata; with RateDistortionReorganizer, a retrieval along the
+    // rate-distortion index is a single contiguous read of a prefix of the data file
+    // the order depends on all levels, so levels are received at once (not streaming)
+    template<class Reorganizer>
+    class ReorganizedFileWriter : public concepts::WriterInterface {
+    public:
+        ReorganizedFileWriter(const std::string& metadata_file, const std::string& data_file, Reorganizer reorganizer) : metadata_file(metadata_file), data_file(data_file), reorganizer(reorganizer) {}
+
+        std::vector<uint32_t> write_level_components(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint64_t>>& level_sizes) const {
+            order.clear();
+            uint64_t total_size = 0;
+            uint8_t * reorganized_data = reorganizer.reorganize(level_components, level_sizes, order, total_size);
+            int fd = open(data_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if(fd < 0){
+                std::cerr << "Errors in open while writing to " << data_file << std::endl;
+                deallocate(reorganized_data);
+                return std::vector<uint32_t>(level_components.size(), 0);
+            }
+            bool success = pwritev_all(fd, std::vector<uint8_t*>(1, reorganized_data), std::vector<uint64_t>(1, total_size), 0);
+            if(!success){
+                std::cerr << "Errors in pwritev while writing to " << data_file << std::endl;
+            }
+            close(fd);
+            deallocate(reorganized_data);
+            return std::vector<uint32_t>(level_components.size(), success ? 1 : 0);
+        }
+
+        bool streaming() const {
+            return false;
+        }
+
+        void load_rate_distortion_index(const RateDistortionIndex& rd_index){
+            reorganizer.load_rate_distortion_index(rd_index);
+        }
+
+        uint32_t write_level_component(int level, const std::vector<uint8_t*>& level_component, const std::vector<uint64_t>& level_sizes) const {
+            std::cerr << "ReorganizedFileWriter: levels are written at once by write_level_components" << std::endl;
+            return 0;
+        }
+
+        // metadata followed by the order table
+        void write_metadata(uint8_t const * metadata, uint64_t size) const {
+            ReorganizedTrailer trailer;
+            trailer.metadata_size = size;
+            trailer.num_bitplanes = order.size();
+            trailer.magic = MDR_REORGANIZED_MAGIC;
+            FILE * file = fopen(metadata_file.c_str(), "w");
+            if(file == NULL){
+                std::cerr << "Errors in open while writing to " << metadata_file << std::endl;
+                return;
+            }
+            fwrite(metadata, 1, size, file);
+            fwrite(order.data(), sizeof(uint8_t), order.size(), file);
+            fwrite(&trailer, sizeof(ReorganizedTrailer), 1, file);
+            fclose(file);
+        }
+
+        ~ReorganizedFileWriter(){}
+
+        void print() const {
+            std::cout << "Reorganized file writer with "; reorganizer.print();
+        }
+    private:
+        std::string metadata_file;
+        std::string data_file;
+        Reorganizer reorganizer;
+        mutable std::vector<uint8_t> order;
+    };
+}
+#endif
@@ -3,5 +3,9 @@
 
 #include "FileWriter.hpp"
 #include "HPSSFileWriter.hpp"
+#include "ContainerFileWriter.hpp"
+#include "BatchContainerWriter.hpp"
+#include "InMemoryWriter.hpp"
+#include "ReorganizedFileWriter.hpp"
 
 #endif
@@ -2,6 +2,8 @@
 #define _MDR_WRITER_INTERFACE_HPP
 
 namespace MDR {
+    struct RateDistortionIndex;
+
     namespace concepts {
 
         // Refactored data writer
@@ -10,9 +12,18 @@ namespace MDR {
 
             virtual ~WriterInterface() = default;
 
-            virtual std::vector<uint32_t> write_level_components(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint32_t>>& level_sizes) const = 0;
+            virtual std::vector<uint32_t> write_level_components(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint64_t>>& level_sizes) const = 0;
+
+            // streaming writers take each level as soon as it is compressed, the caller frees its streams right after
+            // other writers receive all levels at once through write_level_components
+            virtual bool streaming() const = 0;
+
+            virtual uint32_t write_level_component(int level, const std::vector<uint8_t*>& level_component, const std::vector<uint64_t>& level_sizes) const = 0;
+
+            virtual void write_metadata(uint8_t const * metadata, uint64_t size) const = 0;
 
-            virtual void write_metadata(uint8_t const * metadata, uint32_t size) const = 0;
+            // precomputed retrieval order, given before write_level_components; writers that do not use it ignore it
+            virtual void load_rate_distortion_index(const RateDistortionIndex& rd_index) {}
 
             virtual void print() const = 0;
         };
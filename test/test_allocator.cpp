@@ -0,0 +1,161 @@
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstring>
+#include "Allocator/Allocator.hpp"
+#include "ThreadPool.hpp"
+
+using namespace std;
+
+bool check(bool condition, const string& message){
+    cout << (condition ? "PASS: " : "FAIL: ") << message << endl;
+    return condition;
+}
+
+// malloc allocator counting the buffers it hands out
+class CountingAllocator : public MDR::concepts::AllocatorInterface {
+public:
+    void * allocate(size_t size){
+        num_allocations ++;
+        return malloc(size);
+    }
+    void * reallocate(void * ptr, size_t size){
+        return realloc(ptr, size);
+    }
+    void deallocate(void * ptr){
+        free(ptr);
+    }
+    void print() const {
+        cout << "Counting allocator." << endl;
+    }
+    atomic<int> num_allocations{0};
+};
+
+// the installed allocator belongs to the installing thread and follows its pool tasks
+bool test_thread_local_allocator(){
+    bool passed = true;
+    CountingAllocator counting;
+    MDR::ThreadPool pool(4);
+    const int num_tasks = 16;
+    {
+        MDR::AllocatorScope allocator_scope(&counting);
+        // another thread keeps its own allocator
+        thread other([](){ MDR::deallocate(MDR::allocate(64)); });
+        other.join();
+        passed &= check(counting.num_allocations == 0, "an allocator scope does not change the allocator of other threads");
+        vector<future<void>> tasks;
+        for(int i=0; i<num_tasks; i++){
+            tasks.push_back(pool.submit([](){ MDR::deallocate(MDR::allocate(64)); }));
+        }
+        for(auto& t:tasks) t.get();
+        passed &= check(counting.num_allocations == num_tasks, "pool tasks run with the allocator of the submitting thread");
+    }
+    vector<future<bool>> tasks;
+    for(int i=0; i<num_tasks; i++){
+        tasks.push_back(pool.submit([](){ return MDR::current_allocator() == MDR::default_allocator(); }));
+    }
+    bool restored = (MDR::current_allocator() == MDR::default_allocator());
+    for(auto& t:tasks) restored = t.get() && restored;
+    passed &= check(restored && (counting.num_allocations == num_tasks), "workers return to the default allocator after a task");
+    return passed;
+}
+
+// every level bumps its own chunk; release_level hands the chunk over once its buffers are freed
+bool test_arena_levels(){
+    bool passed = true;
+    const size_t chunk_size = 4096;
+    MDR::ArenaAllocator arena(chunk_size);
+    void * level_0 = NULL;
+    void * level_1 = NULL;
+    {
+        MDR::MemoryScope scope("test", 0);
+        level_0 = arena.allocate(100);
+    }
+    {
+        MDR::MemoryScope scope("test", 1);
+        level_1 = arena.allocate(100);
+    }
+    passed &= check((arena.reserved() == 2 * chunk_size) && (arena.live_buffers(0) == 1) && (arena.live_buffers(1) == 1), "arena levels draw from separate chunks");
+    arena.deallocate(level_0);
+    arena.release_level(0);
+    void * level_2 = NULL;
+    {
+        MDR::MemoryScope scope("test", 2);
+        level_2 = arena.allocate(100);
+    }
+    passed &= check((level_2 == level_0) && (arena.reserved() == 2 * chunk_size), "a released level hands its rewound chunk to the next level");
+    {
+        // level 1 still bumps its chunk
+        MDR::MemoryScope scope("test", 1);
+        void * next = arena.allocate(100);
+        passed &= check((next > level_1) && (arena.reserved() == 2 * chunk_size), "an active level keeps its chunk");
+        arena.deallocate(next);
+    }
+    arena.deallocate(level_1);
+    arena.deallocate(level_2);
+    passed &= check(arena.live_buffers() == 0, "arena has no live buffers once all are freed");
+    return passed;
+}
+
+// freeing the most recent buffer rolls the bump pointer back, and it grows or shrinks in place
+bool test_arena_rollback_and_reallocate(){
+    bool passed = true;
+    MDR::ArenaAllocator arena(4096);
+    MDR::MemoryScope scope("test", 0);
+    void * first = arena.allocate(64);
+    void * last = arena.allocate(64);
+    arena.deallocate(last);
+    void * again = arena.allocate(64);
+    passed &= check(again == last, "freeing the last buffer rolls the arena back");
+    arena.deallocate(first);
+    void * next = arena.allocate(64);
+    passed &= check(next != first, "freeing an earlier buffer does not roll the arena back");
+
+    uint8_t * buffer = (uint8_t *) arena.allocate(100);
+    for(int i=0; i<100; i++) buffer[i] = i;
+    uint8_t * grown = (uint8_t *) arena.reallocate(buffer, 1000);
+    uint8_t * shrunk = (uint8_t *) arena.reallocate(grown, 50);
+    passed &= check((grown == buffer) && (shrunk == buffer), "the last buffer is reallocated in place");
+    void * other = arena.allocate(16);
+    uint8_t * moved = (uint8_t *) arena.reallocate(shrunk, 200);
+    bool preserved = (moved != buffer);
+    for(int i=0; i<50; i++) preserved = preserved && (moved[i] == i);
+    passed &= check(preserved, "an earlier buffer is moved with its contents when reallocated");
+    // a buffer larger than a chunk gets a chunk of its own
+    void * large = arena.allocate(10000);
+    passed &= check((large != NULL) && arena.owns(large), "a buffer larger than the chunk size is allocated");
+    for(void * ptr:{again, next, other, (void *) moved, large}) arena.deallocate(ptr);
+    passed &= check(arena.live_buffers() == 0, "arena has no live buffers once all are freed");
+    return passed;
+}
+
+// buffers are returned to the arena that allocated them after its scope has ended
+bool test_arena_owner(){
+    bool passed = true;
+    MDR::ArenaAllocator arena(4096);
+    void * before = MDR::allocate(64);
+    void * inside = NULL;
+    {
+        MDR::AllocatorScope allocator_scope(&arena);
+        inside = MDR::allocate(64);
+        passed &= check(MDR::ArenaAllocator::owner(before) == NULL, "a buffer allocated before the scope is not owned by the arena");
+    }
+    passed &= check((MDR::current_allocator() == MDR::default_allocator()) && (MDR::owning_allocator(inside) == &arena), "the arena owns its buffers after the scope has ended");
+    inside = MDR::reallocate(inside, 128);
+    passed &= check(MDR::owning_allocator(inside) == &arena, "reallocating after the scope stays in the arena");
+    MDR::deallocate(inside);
+    MDR::deallocate(before);
+    passed &= check(arena.live_buffers() == 0, "deallocating after the scope returns the buffer to the arena");
+    return passed;
+}
+
+int main(int argc, char ** argv){
+    bool passed = true;
+    passed &= test_thread_local_allocator();
+    passed &= test_arena_levels();
+    passed &= test_arena_rollback_and_reallocate();
+    passed &= test_arena_owner();
+    return passed ? 0 : -1;
+}
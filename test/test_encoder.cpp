@@ -15,7 +15,7 @@ void evaluate(const vector<T>& data, size_t num_elements, int level_exp, int num
     struct timespec start, end;
     int err = 0;
 
-    vector<uint32_t> sizes;
+    vector<uint64_t> sizes;
     err = clock_gettime(CLOCK_REALTIME, &start);
     std::vector<uint8_t*> streams = encoder.encode(data.data(), num_elements, level_exp, num_bitplanes, sizes);
     err = clock_gettime(CLOCK_REALTIME, &end);
@@ -34,7 +34,7 @@ void evaluate(const vector<T>& data, size_t num_elements, int level_exp, int num
     cout << "Encoded sizes: ";
     for(int i=0; i<sizes.size(); i++){
     	cout << sizes[i] << " ";
-        free(streams[i]);
+        MDR::deallocate(streams[i]);
     }
     cout << endl;
 
@@ -45,7 +45,7 @@ void evaluate(const vector<T>& data, size_t num_elements, int level_exp, int num
     	}
     }
     cout << "Max error = " << max_err << endl;
-    free(dec_data);
+    MDR::deallocate(dec_data);
 }
 
 template <class T>
@@ -5,6 +5,7 @@
 #include <iomanip>
 #include <cmath>
 #include <bitset>
+#include <random>
 #include "utils.hpp"
 #include "BitplaneEncoder/BitplaneEncoder.hpp"
 #include "ErrorCollector/ErrorCollector.hpp"
@@ -12,20 +13,25 @@
 #define MAX(a, b) (a>b) ? (a) : (b)
 using namespace std;
 
+// errors of the data decoded from the first i bitplanes, i = 0 retrieves nothing
 template <class T>
-void compute_true_errors(const vector<T>& data, int num_elements, T max_value){
+vector<double> compute_true_errors(const vector<T>& data, int num_elements, T max_value){
     const int num_bitplanes = 32;
     vector<double> true_max_error(num_bitplanes + 1, 0);
     vector<double> true_squared_error(num_bitplanes + 1, 0);
     MDR::GroupedBPEncoder<T, uint32_t> encoder;
     int level_exp = 0;
     frexp(max_value, &level_exp);
-    vector<uint32_t> sizes;
+    vector<uint64_t> sizes;
     vector<uint8_t*> streams = encoder.encode(data.data(), num_elements, level_exp, num_bitplanes, sizes);
     std::vector<uint8_t const*> streams_const;
     for(int i=0; i<streams.size(); i++){
         streams_const.push_back(streams[i]);
     }
+    for(int j=0; j<data.size(); j++){
+        true_max_error[0] = MAX(true_max_error[0], fabs(data[j]));
+        true_squared_error[0] += (double) data[j] * data[j];
+    }
     for(int i=1; i<=num_bitplanes; i++){
         auto dec_data = encoder.decode(streams_const, num_elements, level_exp, i);
         double max_error = 0;
@@ -37,10 +43,10 @@ void compute_true_errors(const vector<T>& data, int num_elements, T max_value){
         true_max_error[i] = max_error;
         true_squared_error[i] = squared_error;
         // cout << "max_error = " << max_error << ", squared_error = " << squared_error << endl;
-        free(dec_data);
+        MDR::deallocate(dec_data);
     }
     for(int i=0; i<streams.size(); i++){
-        free(streams[i]);
+        MDR::deallocate(streams[i]);
     }
     cout << "True max errors: " << endl;
     for(int i=0; i<true_max_error.size(); i++){
@@ -54,10 +60,11 @@ void compute_true_errors(const vector<T>& data, int num_elements, T max_value){
     }
     cout << endl;
     cout << endl;
+    return true_squared_error;
 }
 
 template <class T, class ErrorCollector>
-void evaluate(const vector<T>& data, int num_elements, T max_value, ErrorCollector collector){
+vector<double> evaluate(const vector<T>& data, int num_elements, T max_value, ErrorCollector collector){
     struct timespec start, end;
     int err = 0;
 
@@ -75,25 +82,72 @@ void evaluate(const vector<T>& data, int num_elements, T max_value, ErrorCollect
     }
     cout << endl;
     cout << endl;
+    return collected_error;
+}
+
+bool check(bool condition, const string& message){
+    cout << (condition ? "PASS: " : "FAIL: ") << message << endl;
+    return condition;
+}
+
+bool close_to(double value, double reference){
+    return fabs(value - reference) <= 1e-6 * reference + 1e-300;
 }
 
 template <class T>
-void test(string filename){
-    size_t num_elements = 0;
-    auto data = MGARD::readfile<T>(filename.c_str(), num_elements);
+bool test(const vector<T>& data){
+    const int num_elements = data.size();
     T max_val = 0;
     for(int i=0; i<num_elements; i++){
         if(fabs(data[i]) > max_val) max_val = fabs(data[i]);
     }
-    compute_true_errors(data, num_elements, max_val);
+    auto true_errors = compute_true_errors(data, num_elements, max_val);
     evaluate(data, num_elements, max_val, MDR::MaxErrorCollector<T>());
-    evaluate(data, num_elements, max_val, MDR::SquaredErrorCollector<T>());
+    auto squared_errors = evaluate(data, num_elements, max_val, MDR::SquaredErrorCollector<T>());
+    auto histogram_errors = evaluate(data, num_elements, max_val, MDR::HistogramErrorCollector<T>());
+    auto fine_histogram_errors = evaluate(data, num_elements, max_val, MDR::HistogramErrorCollector<T>(8));
+
+    bool passed = true;
+    bool exact = (squared_errors.size() == true_errors.size());
+    bool bounded = (histogram_errors.size() == true_errors.size());
+    bool tighter = (fine_histogram_errors.size() == true_errors.size());
+    int level_exp = 0;
+    frexp(max_val, &level_exp);
+    for(int i=0; i<true_errors.size(); i++){
+        exact = exact && close_to(squared_errors[i], true_errors[i]);
+        // at least the exact error, and below one unit of the last retrieved bitplane per value
+        bounded = bounded && (histogram_errors[i] >= true_errors[i] * (1 - 1e-6)) && (histogram_errors[i] <= num_elements * ldexp(1.0, 2 * (level_exp - i)));
+        // finer bins bound every value more tightly
+        tighter = tighter && (fine_histogram_errors[i] >= true_errors[i] * (1 - 1e-6)) && (fine_histogram_errors[i] <= histogram_errors[i] * (1 + 1e-6));
+    }
+    passed &= check(exact, "closed-form squared errors match the decoded errors");
+    passed &= check(bounded, "histogram errors bound the decoded errors");
+    passed &= check(tighter, "histogram with more mantissa bits gives a tighter bound");
+    return passed;
+}
+
+// without a data file, values spread over several orders of magnitude
+template <class T>
+vector<T> synthetic_data(size_t num_elements){
+    std::mt19937 generator(42);
+    std::normal_distribution<double> distribution(0, 1);
+    vector<T> data(num_elements);
+    for(auto& value:data){
+        value = distribution(generator) * exp(2 * distribution(generator));
+    }
+    data[0] = 0;
+    return data;
 }
 
 int main(int argc, char ** argv){
 
-    string filename = string(argv[1]);
-    test<float>(filename);
-    return 0;
+    vector<float> data;
+    if(argc > 1){
+        string filename = string(argv[1]);
+        size_t num_elements = 0;
+        data = MGARD::readfile<float>(filename.c_str(), num_elements);
+    }
+    else data = synthetic_data<float>(1 << 18);
+    return test<float>(data) ? 0 : -1;
 
 }
\ No newline at end of file
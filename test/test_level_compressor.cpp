@@ -0,0 +1,124 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <random>
+#include "LosslessCompressor/LevelCompressor.hpp"
+
+using namespace std;
+
+bool check(bool condition, const string& message){
+    cout << (condition ? "PASS: " : "FAIL: ") << message << endl;
+    return condition;
+}
+
+// bitplanes of a level: compressible, incompressible (kept as raw chunks), and half of each with a partial last chunk
+vector<vector<uint8_t>> generate_bitplanes(){
+    mt19937 rng(7);
+    uniform_int_distribution<int> byte_dist(0, 255);
+    vector<vector<uint8_t>> bitplanes(3);
+    for(int k=0; k<1000; k++) bitplanes[0].push_back((k / 50) % 3);
+    for(int k=0; k<1000; k++) bitplanes[1].push_back(byte_dist(rng));
+    for(int k=0; k<950; k++) bitplanes[2].push_back((k < 500) ? 0 : byte_dist(rng));
+    return bitplanes;
+}
+
+vector<uint8_t*> copy_streams(const vector<vector<uint8_t>>& bitplanes, vector<uint64_t>& stream_sizes){
+    vector<uint8_t*> streams;
+    stream_sizes.clear();
+    for(const auto& bitplane:bitplanes){
+        uint8_t * stream = (uint8_t *) MDR::allocate(bitplane.size());
+        memcpy(stream, bitplane.data(), bitplane.size());
+        streams.push_back(stream);
+        stream_sizes.push_back(bitplane.size());
+    }
+    return streams;
+}
+
+MDR::ChunkIndex read_index(uint8_t const * stream){
+    MDR::ChunkIndex index;
+    index.deserialize(stream);
+    return index;
+}
+
+bool test_chunked_round_trip(){
+    bool passed = true;
+    // 100-byte chunks
+    MDR::ChunkedLevelCompressor compressor(800, 4);
+    auto bitplanes = generate_bitplanes();
+    vector<uint64_t> stream_sizes;
+    auto streams = copy_streams(bitplanes, stream_sizes);
+    auto flags = compressor.compress_level(streams, stream_sizes);
+    passed &= check(flags == vector<uint8_t>(bitplanes.size(), 1), "every chunked stream carries its own index");
+
+    auto compressible = read_index(streams[0]);
+    auto incompressible = read_index(streams[1]);
+    auto mixed = read_index(streams[2]);
+    bool index_ok = (compressible.num_chunks() == 10) && (mixed.num_chunks() == 10) && (mixed.raw_chunk_size(9) == 50);
+    for(int k=0; k<10; k++){
+        index_ok = index_ok && compressible.flags[k] && !incompressible.flags[k] && (mixed.flags[k] == (k < 5));
+    }
+    passed &= check(index_ok, "compressible chunks use ZSTD and incompressible chunks stay raw");
+    passed &= check(stream_sizes[0] < bitplanes[0].size() && stream_sizes[1] == incompressible.header_size() + bitplanes[1].size(), "chunked stream sizes");
+
+    vector<const uint8_t*> level_components(streams.begin(), streams.end());
+    compressor.decompress_level(level_components, stream_sizes, 0, bitplanes.size(), flags);
+    bool identical = true;
+    for(int i=0; i<bitplanes.size(); i++){
+        identical = identical && !memcmp(level_components[i], bitplanes[i].data(), bitplanes[i].size());
+    }
+    passed &= check(identical, "chunked level round trip");
+    compressor.decompress_release();
+
+    // decompress a byte range from the header and the payloads given by stream_range only
+    const uint64_t begin = 230;
+    const uint64_t end = 780;
+    auto chunks = mixed.overlapping(begin, end);
+    auto range = mixed.stream_range(begin, end);
+    passed &= check((chunks.first == 2) && (chunks.second == 8) && (range.first == mixed.header_size() + mixed.offsets[2]) && (range.second == mixed.header_size() + mixed.offsets[8]), "chunks and stream bytes overlapping a byte range");
+    vector<uint8_t> fetched(stream_sizes[2], 0xff);
+    memcpy(fetched.data(), streams[2], mixed.header_size());
+    memcpy(fetched.data() + range.first, streams[2] + range.first, range.second - range.first);
+    const uint8_t untouched = 0xa5;
+    vector<uint8_t> data(bitplanes[2].size(), untouched);
+    compressor.decompress_range(fetched.data(), begin, end, data.data());
+    bool range_ok = true;
+    for(uint64_t k=0; k<data.size(); k++){
+        if(k >= chunks.first * 100 && k < chunks.second * 100) range_ok = range_ok && (data[k] == bitplanes[2][k]);
+        else range_ok = range_ok && (data[k] == untouched);
+    }
+    passed &= check(range_ok, "partial range decode only writes the overlapping chunks");
+    passed &= check(mixed.overlapping(900, 2000) == make_pair(9u, 10u) && mixed.overlapping(950, 1000) == make_pair(0u, 0u), "ranges are clamped to the raw size");
+
+    for(auto& stream:streams) MDR::deallocate(stream);
+    return passed;
+}
+
+// zero samples or an empty sample still predict from at least one byte
+bool test_adaptive_degenerate_sampling(){
+    bool passed = true;
+    for(auto params:{make_pair(0u, 0u), make_pair(4u, 0u), make_pair(2u, 8u)}){
+        MDR::AdaptiveLevelCompressor compressor(26, params.first, params.second);
+        auto bitplanes = generate_bitplanes();
+        vector<uint64_t> stream_sizes;
+        auto streams = copy_streams(bitplanes, stream_sizes);
+        auto flags = compressor.compress_level(streams, stream_sizes);
+        vector<const uint8_t*> level_components(streams.begin(), streams.end());
+        compressor.decompress_level(level_components, stream_sizes, 0, bitplanes.size(), flags);
+        bool identical = true;
+        for(int i=0; i<bitplanes.size(); i++){
+            identical = identical && !memcmp(level_components[i], bitplanes[i].data(), bitplanes[i].size());
+        }
+        passed &= check(identical, "adaptive round trip with sample size " + to_string(params.first) + " and " + to_string(params.second) + " samples");
+        compressor.decompress_release();
+        for(auto& stream:streams) MDR::deallocate(stream);
+    }
+    return passed;
+}
+
+int main(int argc, char ** argv){
+    bool passed = true;
+    passed &= test_chunked_round_trip();
+    passed &= test_adaptive_degenerate_sampling();
+    return passed ? 0 : -1;
+}
@@ -11,8 +11,6 @@
 
 using namespace std;
 
-vector<double> cc(5, 1);
-
 template <class T>
 void print_statistics(const T * data_ori, const T * data_dec, size_t data_size){
     double max_val = data_ori[0];
@@ -111,17 +109,16 @@ int main(int argc, char ** argv){
         // metadata interpreter, otherwise information needs to be provided
         size_t num_bytes = 0;
         auto metadata = MGARD::readfile<uint8_t>(metadata_file.c_str(), num_bytes);
-        assert(num_bytes > num_dims * sizeof(uint32_t) + 2);
-        num_dims = metadata[0];
-        num_levels = metadata[num_dims * sizeof(uint32_t) + 1];
+        assert(num_bytes > 2);
+        uint8_t const * metadata_pos = metadata.data();
+        MDR::read_metadata_header(metadata_pos);
+        num_dims = metadata_pos[0];
+        num_levels = metadata_pos[num_dims * sizeof(uint32_t) + 1];
         //cout << "number of dimension = " << num_dims << ", number of levels = " << num_levels << endl;
     }
 
-    cc[0] = 1.0 + 21.0*sqrt(3)/8;
-    cc[1] = 1.0 + 21.0*sqrt(3)/8;
-    cc[2] = 1.0 + 21.0*sqrt(3)/8;
-    cc[3] = 1.0 + 21.0*sqrt(3)/8;
-    cc[4] = 1.0 + 21.0*sqrt(3)/8;
+    // per-level constants for max error estimation
+    vector<double> cc(num_levels, 1.0 + 21.0*sqrt(3)/8);
     for(int i=0; i<num_levels; i++){
         cc[i] = atof(argv[argv_id ++]);
     }
@@ -147,7 +144,15 @@ int main(int argc, char ** argv){
     // auto compressor = MDR::DefaultLevelCompressor();
     auto compressor = MDR::AdaptiveLevelCompressor(32);
     // auto compressor = MDR::NullLevelCompressor();
+    // auto compressor = MDR::ChunkedLevelCompressor();
     auto retriever = MDR::ConcatLevelFileRetriever(metadata_file, files);
+    // auto retriever = MDR::MmapLevelFileRetriever(metadata_file, files);
+    // auto retriever = MDR::PrefetchLevelFileRetriever(metadata_file, files);
+    // auto retriever = MDR::ContainerFileRetriever(string(token_) + "/refactored.mdr");
+    // auto retriever = MDR::HPSSFileRetriever(metadata_file, files);
+    // auto retriever = MDR::ReorganizedFileRetriever(metadata_file, string(token_) + "/reorganized.bin");
+    // MDR::ArenaAllocator arena;
+    // MDR::AllocatorScope allocator_scope(&arena);
     switch(error_mode){
         case 1:{
             auto estimator = MDR::SNormErrorEstimator<T>(num_dims, num_levels - 1, s);
@@ -155,16 +160,25 @@ int main(int argc, char ** argv){
             auto interpreter = MDR::NegaBinaryGreedyBasedSizeInterpreter<MDR::SNormErrorEstimator<T>>(estimator);
             // auto interpreter = MDR::RoundRobinSizeInterpreter<MDR::SNormErrorEstimator<T>>(estimator);
             // auto interpreter = MDR::InorderSizeInterpreter<MDR::SNormErrorEstimator<T>>(estimator);
+            // auto interpreter = MDR::RateDistortionSizeInterpreter<MDR::SNormErrorEstimator<T>>(estimator);
+            // auto interpreter = MDR::OptimalSizeInterpreter<MDR::SNormErrorEstimator<T>>(estimator);
+            // auto interpreter = MDR::BudgetGreedyBasedSizeInterpreter<MDR::SNormErrorEstimator<T>>(estimator, 64 * 1024 * 1024);
+            // auto interpreter = MDR::DeadlineGreedyBasedSizeInterpreter<MDR::SNormErrorEstimator<T>>(estimator, 0.1);
             // auto estimator = MDR::L2ErrorEstimator_HB<T>(num_dims, num_levels - 1);
             // auto interpreter = MDR::SignExcludeGreedyBasedSizeInterpreter<MDR::L2ErrorEstimator_HB<T>>(estimator);
             test<T>(filename, tolerance, decomposer, interleaver, encoder, compressor, estimator, interpreter, retriever);            
             break;
         }
         default:{ // max error
-            auto estimator = MDR::MaxErrorEstimatorOB<T>(num_dims);
+            vector<T> level_c(num_levels);
+            for(int i=0; i<num_levels; i++){
+                level_c[i] = cc[i] * 4; // 2 more bitplane for negabinary
+            }
+            auto estimator = MDR::MaxErrorEstimatorOB<T>(level_c);
             auto interpreter = MDR::SignExcludeGreedyBasedSizeInterpreter<MDR::MaxErrorEstimatorOB<T>>(estimator);
             // auto interpreter = MDR::RoundRobinSizeInterpreter<MDR::MaxErrorEstimatorOB<T>>(estimator);
             // auto interpreter = MDR::InorderSizeInterpreter<MDR::MaxErrorEstimatorOB<T>>(estimator);
+            // auto interpreter = MDR::OptimalSizeInterpreter<MDR::MaxErrorEstimatorOB<T>>(estimator);
             // auto estimator = MDR::MaxErrorEstimatorHB<T>();
             // auto interpreter = MDR::SignExcludeGreedyBasedSizeInterpreter<MDR::MaxErrorEstimatorHB<T>>(estimator);
             test<T>(filename, tolerance, decomposer, interleaver, encoder, compressor, estimator, interpreter, retriever);
@@ -27,6 +27,7 @@ void evaluate(const vector<T>& data, const vector<uint32_t>& dims, int target_le
 template <class T, class Decomposer, class Interleaver, class Encoder, class Compressor, class ErrorCollector, class Writer>
 void test(string filename, const vector<uint32_t>& dims, int target_level, int num_bitplanes, Decomposer decomposer, Interleaver interleaver, Encoder encoder, Compressor compressor, ErrorCollector collector, Writer writer){
     auto refactor = MDR::ComposedRefactor<T, Decomposer, Interleaver, Encoder, Compressor, ErrorCollector, Writer>(decomposer, interleaver, encoder, compressor, collector, writer);
+    // refactor.set_rate_distortion_estimator(MDR::SNormErrorEstimator<T>(dims.size(), target_level, 0));
     size_t num_elements = 0;
     auto data = MGARD::readfile<T>(filename.c_str(), num_elements);
     //cout << "begin eval" << std::endl;
@@ -110,10 +111,18 @@ int main(int argc, char ** argv){
     // auto compressor = MDR::DefaultLevelCompressor();
     auto compressor = MDR::AdaptiveLevelCompressor(32);
     // auto compressor = MDR::NullLevelCompressor();
+    // auto compressor = MDR::ChunkedLevelCompressor();
     //auto collector = MDR::SquaredErrorCollector<T>();
     auto collector = MDR::MaxErrorCollector<T>();
+    // auto collector = MDR::HistogramErrorCollector<T>();
     auto writer = MDR::ConcatLevelFileWriter(metadata_file, files);
     // auto writer = MDR::HPSSFileWriter(metadata_file, files, 2048, 512 * 1024 * 1024);
+    // auto writer = MDR::ContainerFileWriter(string(token_) + "/refactored.mdr");
+    // single data file in rate-distortion order, needs refactor.set_rate_distortion_estimator
+    // auto writer = MDR::ReorganizedFileWriter<MDR::RateDistortionReorganizer>(metadata_file, string(token_) + "/reorganized.bin", MDR::RateDistortionReorganizer());
+    // draw the per-level streams and buffers from an arena instead of malloc
+    // MDR::ArenaAllocator arena;
+    // MDR::AllocatorScope allocator_scope(&arena);
 
     //std::cout << "begin test" << std::endl;
     test<T>(filename, dims, target_level, num_bitplanes, decomposer, interleaver, encoder, compressor, collector, writer);
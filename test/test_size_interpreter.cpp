@@ -0,0 +1,327 @@
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <functional>
+#include "SizeInterpreter/SizeInterpreter.hpp"
+
+using namespace std;
+
+// synthetic levels: sizes grow and squared errors halve with every bitplane, the last error stays positive
+void generate_levels(int num_levels, int num_bitplanes, vector<vector<uint64_t>>& level_sizes, vector<vector<double>>& level_errors){
+    level_sizes.clear();
+    level_errors.clear();
+    for(int i=0; i<num_levels; i++){
+        vector<uint64_t> sizes;
+        vector<double> errors;
+        for(int j=0; j<num_bitplanes; j++){
+            sizes.push_back(64 * (i + 1) + 16 * j);
+        }
+        for(int j=0; j<=num_bitplanes; j++){
+            errors.push_back(ldexp(1.0 + i, -j));
+        }
+        level_sizes.push_back(sizes);
+        level_errors.push_back(errors);
+    }
+}
+
+bool check(bool condition, const string& message){
+    cout << (condition ? "PASS: " : "FAIL: ") << message << endl;
+    return condition;
+}
+
+template <class SizeInterpreter>
+bool test_unreachable_tolerance(SizeInterpreter interpreter, const string& name){
+    const int num_levels = 3;
+    const int num_bitplanes = 8;
+    vector<vector<uint64_t>> level_sizes;
+    vector<vector<double>> level_errors;
+    generate_levels(num_levels, num_bitplanes, level_sizes, level_errors);
+    uint64_t total_size = 0;
+    for(const auto& sizes:level_sizes) total_size += accumulate(sizes.begin(), sizes.end(), (uint64_t) 0);
+
+    bool passed = true;
+    vector<uint8_t> index(num_levels, 0);
+    // no bitplane count reaches a zero error: everything is retrieved
+    auto retrieve_sizes = interpreter.interpret_retrieve_size(level_sizes, level_errors, 0, index);
+    uint64_t retrieved = accumulate(retrieve_sizes.begin(), retrieve_sizes.end(), (uint64_t) 0);
+    bool all_bitplanes = true;
+    for(int i=0; i<num_levels; i++) all_bitplanes = all_bitplanes && (index[i] == num_bitplanes);
+    passed &= check(all_bitplanes && (retrieved == total_size), name + " retrieves all bitplanes for an unreachable tolerance");
+    // a second unreachable request has nothing left to retrieve
+    retrieve_sizes = interpreter.interpret_retrieve_size(level_sizes, level_errors, 0, index);
+    retrieved = accumulate(retrieve_sizes.begin(), retrieve_sizes.end(), (uint64_t) 0);
+    passed &= check(retrieved == 0, name + " retrieves nothing once all bitplanes are retrieved");
+    return passed;
+}
+
+// bitplanes already retrieved need not be a prefix of the rate-distortion order, e.g. after reconstructing to given bitplanes
+template <class ErrorEstimator>
+bool test_rate_distortion_non_prefix(const ErrorEstimator& estimator){
+    const int num_levels = 3;
+    const int num_bitplanes = 8;
+    vector<vector<uint64_t>> level_sizes;
+    vector<vector<double>> level_errors;
+    generate_levels(num_levels, num_bitplanes, level_sizes, level_errors);
+    auto interpreter = MDR::RateDistortionSizeInterpreter<ErrorEstimator>(estimator);
+
+    bool passed = true;
+    const vector<uint8_t> prev_index = {num_bitplanes, 0, 3};
+    for(double tolerance:{1.0, 0.0}){
+        vector<uint8_t> index(prev_index);
+        auto retrieve_sizes = interpreter.interpret_retrieve_size(level_sizes, level_errors, tolerance, index);
+        bool consistent = true;
+        for(int i=0; i<num_levels; i++){
+            uint64_t expected = 0;
+            for(int j=prev_index[i]; j<index[i]; j++) expected += level_sizes[i][j];
+            consistent = consistent && (index[i] >= prev_index[i]) && (index[i] <= num_bitplanes) && (retrieve_sizes[i] == expected);
+        }
+        passed &= check(consistent, "rate-distortion interpreter skips retrieved bitplanes outside its order (tolerance " + to_string(tolerance) + ")");
+        if(tolerance == 0){
+            bool all_bitplanes = true;
+            for(int i=0; i<num_levels; i++) all_bitplanes = all_bitplanes && (index[i] == num_bitplanes);
+            passed &= check(all_bitplanes, "rate-distortion interpreter completes every level from a non-prefix state");
+        }
+    }
+    {
+        // the budget counts the bitplanes already retrieved
+        vector<uint8_t> index(prev_index);
+        uint64_t retrieved_size = 0;
+        for(int i=0; i<num_levels; i++) retrieved_size += accumulate(level_sizes[i].begin(), level_sizes[i].begin() + prev_index[i], (uint64_t) 0);
+        const uint64_t budget = retrieved_size + 200;
+        auto retrieve_sizes = interpreter.interpret_retrieve_size_by_budget(level_sizes, level_errors, budget, index);
+        uint64_t retrieved = accumulate(retrieve_sizes.begin(), retrieve_sizes.end(), (uint64_t) 0);
+        passed &= check((retrieved > 0) && (retrieved_size + retrieved <= budget), "rate-distortion budget includes bitplanes retrieved outside its order");
+    }
+    return passed;
+}
+
+// an index stored by another error estimator is ignored
+template <class ErrorEstimator>
+bool test_rate_distortion_estimator(const ErrorEstimator& estimator, const ErrorEstimator& other_estimator){
+    const int num_levels = 3;
+    vector<vector<uint64_t>> level_sizes;
+    vector<vector<double>> level_errors;
+    generate_levels(num_levels, 8, level_sizes, level_errors);
+    auto rd_index = MDR::build_rate_distortion_index(level_sizes, level_errors, estimator);
+    auto other_rd_index = MDR::build_rate_distortion_index(level_sizes, level_errors, other_estimator);
+
+    bool passed = true;
+    vector<uint8_t> buffer(rd_index.get_size());
+    uint8_t * buffer_pos = buffer.data();
+    rd_index.serialize(buffer_pos);
+    MDR::RateDistortionIndex loaded_index;
+    uint8_t const * loaded_pos = buffer.data();
+    loaded_index.deserialize(loaded_pos);
+    passed &= check((buffer_pos == buffer.data() + buffer.size()) && (loaded_pos == buffer_pos), "rate-distortion index serializes to get_size() bytes");
+    passed &= check(loaded_index.built_by(estimator) && !loaded_index.built_by(other_estimator), "rate-distortion index records its error estimator");
+
+    auto interpreter = MDR::RateDistortionSizeInterpreter<ErrorEstimator>(estimator);
+    auto loaded_interpreter = MDR::RateDistortionSizeInterpreter<ErrorEstimator>(estimator);
+    loaded_interpreter.load_rate_distortion_index(other_rd_index);
+    vector<uint8_t> index(num_levels, 0);
+    vector<uint8_t> loaded_index_bitplanes(num_levels, 0);
+    const double tolerance = 0.5;
+    auto retrieve_sizes = interpreter.interpret_retrieve_size(level_sizes, level_errors, tolerance, index);
+    auto loaded_retrieve_sizes = loaded_interpreter.interpret_retrieve_size(level_sizes, level_errors, tolerance, loaded_index_bitplanes);
+    passed &= check((retrieve_sizes == loaded_retrieve_sizes) && (index == loaded_index_bitplanes), "rate-distortion interpreter ignores an index of another error estimator");
+    return passed;
+}
+
+// irregular levels on which greedy selection is not optimal
+void generate_random_levels(int num_levels, int num_bitplanes, unsigned seed, vector<vector<uint64_t>>& level_sizes, vector<vector<double>>& level_errors){
+    mt19937 rng(seed);
+    uniform_int_distribution<int> size_dist(8, 256);
+    uniform_real_distribution<double> decay_dist(0.05, 0.9);
+    level_sizes.clear();
+    level_errors.clear();
+    for(int i=0; i<num_levels; i++){
+        vector<uint64_t> sizes;
+        vector<double> errors(1, 1.0 + i);
+        for(int j=0; j<num_bitplanes; j++){
+            sizes.push_back(size_dist(rng));
+            errors.push_back(errors.back() * decay_dist(rng));
+        }
+        level_sizes.push_back(sizes);
+        level_errors.push_back(errors);
+    }
+}
+
+// minimal total size over all bitplane counts of at least min_bitplanes whose estimated error is below tolerance
+// returns false if no selection meets the tolerance
+template <class ErrorEstimator>
+bool brute_force_min_size(const vector<vector<uint64_t>>& level_sizes, const vector<vector<double>>& level_errors, const ErrorEstimator& estimator, double tolerance, const vector<uint8_t>& min_bitplanes, uint64_t& min_size, vector<uint8_t>& selection){
+    const int num_levels = level_sizes.size();
+    vector<uint8_t> counts(num_levels);
+    bool found = false;
+    function<void(int, uint64_t, double)> visit = [&](int i, uint64_t size, double error){
+        if(i == num_levels){
+            if((error < tolerance) && (!found || size < min_size)){
+                found = true;
+                min_size = size;
+                selection = counts;
+            }
+            return;
+        }
+        uint64_t level_size = accumulate(level_sizes[i].begin(), level_sizes[i].begin() + min_bitplanes[i], (uint64_t) 0);
+        for(int k=min_bitplanes[i]; k<=level_sizes[i].size(); k++){
+            if(k > min_bitplanes[i]) level_size += level_sizes[i][k - 1];
+            counts[i] = k;
+            visit(i + 1, size + level_size, error + estimator.estimate_error(level_errors[i][k], i));
+        }
+    };
+    visit(0, 0, 0);
+    return found;
+}
+
+template <class ErrorEstimator>
+double estimated_error(const vector<vector<double>>& level_errors, const ErrorEstimator& estimator, const vector<uint8_t>& index){
+    double error = 0;
+    for(int i=0; i<index.size(); i++) error += estimator.estimate_error(level_errors[i][index[i]], i);
+    return error;
+}
+
+uint64_t retrieved_size(const vector<vector<uint64_t>>& level_sizes, const vector<uint8_t>& index){
+    uint64_t size = 0;
+    for(int i=0; i<index.size(); i++) size += accumulate(level_sizes[i].begin(), level_sizes[i].begin() + index[i], (uint64_t) 0);
+    return size;
+}
+
+// the optimal interpreter meets the tolerance with the fewest bytes and never retrieves more than the greedy one
+template <class ErrorEstimator>
+bool test_optimal_selection(const ErrorEstimator& estimator){
+    const int num_levels = 3;
+    const int num_bitplanes = 6;
+    bool passed = true;
+    int num_cases = 0;
+    int num_optimal = 0;
+    int num_not_above_greedy = 0;
+    int num_below_greedy = 0;
+    for(unsigned seed=1; seed<=8; seed++){
+        vector<vector<uint64_t>> level_sizes;
+        vector<vector<double>> level_errors;
+        generate_random_levels(num_levels, num_bitplanes, seed, level_sizes, level_errors);
+        for(double tolerance=4.0; tolerance>1e-4; tolerance*=0.37){
+            uint64_t min_size = 0;
+            vector<uint8_t> selection;
+            if(!brute_force_min_size(level_sizes, level_errors, estimator, tolerance, vector<uint8_t>(num_levels, 0), min_size, selection)) continue;
+            auto optimal = MDR::OptimalSizeInterpreter<ErrorEstimator>(estimator);
+            auto greedy = MDR::GreedyBasedSizeInterpreter<ErrorEstimator>(estimator);
+            vector<uint8_t> optimal_index(num_levels, 0);
+            vector<uint8_t> greedy_index(num_levels, 0);
+            optimal.interpret_retrieve_size(level_sizes, level_errors, tolerance, optimal_index);
+            greedy.interpret_retrieve_size(level_sizes, level_errors, tolerance, greedy_index);
+            uint64_t optimal_size = retrieved_size(level_sizes, optimal_index);
+            uint64_t greedy_size = retrieved_size(level_sizes, greedy_index);
+            num_cases ++;
+            num_optimal += (optimal_size == min_size) && (estimated_error(level_errors, estimator, optimal_index) < tolerance);
+            num_not_above_greedy += (optimal_size <= greedy_size);
+            num_below_greedy += (optimal_size < greedy_size);
+        }
+    }
+    passed &= check(num_cases && (num_optimal == num_cases), "optimal interpreter meets the tolerance with the brute-force minimum size (" + to_string(num_optimal) + "/" + to_string(num_cases) + ")");
+    passed &= check(num_not_above_greedy == num_cases, "optimal interpreter never retrieves more than the greedy interpreter");
+    // the levels are irregular enough for the comparison to matter
+    passed &= check(num_below_greedy > 0, "optimal interpreter retrieves less than the greedy interpreter on some requests");
+    return passed;
+}
+
+// progressive requests: each selection is minimal given the bitplanes already retrieved,
+// including requests whose unconstrained optimum drops retrieved bitplanes and forces the lower-bound rebuild
+template <class ErrorEstimator>
+bool test_optimal_progressive(const ErrorEstimator& estimator){
+    const int num_levels = 3;
+    const int num_bitplanes = 6;
+    bool passed = true;
+    int num_requests = 0;
+    int num_optimal = 0;
+    int num_rebuilds = 0;
+    for(unsigned seed=1; seed<=8; seed++){
+        vector<vector<uint64_t>> level_sizes;
+        vector<vector<double>> level_errors;
+        generate_random_levels(num_levels, num_bitplanes, seed, level_sizes, level_errors);
+        auto interpreter = MDR::OptimalSizeInterpreter<ErrorEstimator>(estimator);
+        vector<uint8_t> index(num_levels, 0);
+        for(double tolerance=4.0; tolerance>1e-4; tolerance*=0.6){
+            uint64_t min_size = 0;
+            vector<uint8_t> selection;
+            vector<uint8_t> unconstrained;
+            uint64_t unconstrained_size = 0;
+            if(!brute_force_min_size(level_sizes, level_errors, estimator, tolerance, index, min_size, selection)) continue;
+            brute_force_min_size(level_sizes, level_errors, estimator, tolerance, vector<uint8_t>(num_levels, 0), unconstrained_size, unconstrained);
+            for(int i=0; i<num_levels; i++){
+                if(unconstrained[i] < index[i]){
+                    num_rebuilds ++;
+                    break;
+                }
+            }
+            interpreter.interpret_retrieve_size(level_sizes, level_errors, tolerance, index);
+            num_requests ++;
+            num_optimal += (retrieved_size(level_sizes, index) == min_size) && (estimated_error(level_errors, estimator, index) < tolerance);
+        }
+    }
+    passed &= check(num_requests && (num_optimal == num_requests), "progressive optimal selections are minimal given the retrieved bitplanes (" + to_string(num_optimal) + "/" + to_string(num_requests) + ")");
+    passed &= check(num_rebuilds > 0, "progressive requests exercise the lower-bound rebuild (" + to_string(num_rebuilds) + " requests)");
+    return passed;
+}
+
+// thinned frontiers no longer give the minimum on every request, but still meet the tolerance
+template <class ErrorEstimator>
+bool test_optimal_thinned(const ErrorEstimator& estimator){
+    const int num_levels = 4;
+    const int num_bitplanes = 6;
+    const size_t max_frontier_size = 8;
+    bool passed = true;
+    int num_cases = 0;
+    int num_within_tolerance = 0;
+    int num_thinned = 0;
+    for(unsigned seed=1; seed<=4; seed++){
+        vector<vector<uint64_t>> level_sizes;
+        vector<vector<double>> level_errors;
+        generate_random_levels(num_levels, num_bitplanes, seed, level_sizes, level_errors);
+        for(double tolerance=4.0; tolerance>1e-4; tolerance*=0.37){
+            uint64_t min_size = 0;
+            vector<uint8_t> selection;
+            if(!brute_force_min_size(level_sizes, level_errors, estimator, tolerance, vector<uint8_t>(num_levels, 0), min_size, selection)) continue;
+            auto thinned = MDR::OptimalSizeInterpreter<ErrorEstimator>(estimator, max_frontier_size);
+            vector<uint8_t> index(num_levels, 0);
+            thinned.interpret_retrieve_size(level_sizes, level_errors, tolerance, index);
+            uint64_t size = retrieved_size(level_sizes, index);
+            num_cases ++;
+            num_within_tolerance += (estimated_error(level_errors, estimator, index) < tolerance) && (size >= min_size);
+            num_thinned += (size > min_size);
+        }
+    }
+    passed &= check(num_cases && (num_within_tolerance == num_cases), "thinned optimal selections meet the tolerance (" + to_string(num_within_tolerance) + "/" + to_string(num_cases) + ")");
+    // 7^4 bitplane counts do not fit in 8 frontier points: thinning changes some selections
+    passed &= check(num_thinned > 0, "frontier thinning is exercised (" + to_string(num_thinned) + " requests above the minimum)");
+    return passed;
+}
+
+int main(int argc, char ** argv){
+    using T = float;
+    auto estimator = MDR::SNormErrorEstimator<T>(1, 2, 0);
+    bool passed = true;
+    passed &= test_unreachable_tolerance(MDR::RateDistortionSizeInterpreter<MDR::SNormErrorEstimator<T>>(estimator), "rate-distortion interpreter");
+    passed &= test_unreachable_tolerance(MDR::SignExcludeGreedyBasedSizeInterpreter<MDR::SNormErrorEstimator<T>>(estimator), "sign-excluding greedy interpreter");
+    passed &= test_unreachable_tolerance(MDR::GreedyBasedSizeInterpreter<MDR::SNormErrorEstimator<T>>(estimator), "greedy interpreter");
+    passed &= test_unreachable_tolerance(MDR::BudgetGreedyBasedSizeInterpreter<MDR::SNormErrorEstimator<T>>(estimator, -1), "budget greedy interpreter");
+    passed &= test_unreachable_tolerance(MDR::OptimalSizeInterpreter<MDR::SNormErrorEstimator<T>>(estimator), "optimal interpreter");
+    {
+        // a budget beyond the total size is capped by the last step of the index
+        vector<vector<uint64_t>> level_sizes;
+        vector<vector<double>> level_errors;
+        generate_levels(3, 8, level_sizes, level_errors);
+        auto rd_index = MDR::build_rate_distortion_index(level_sizes, level_errors, estimator);
+        passed &= check(rd_index.locate_tolerance(0) == rd_index.num_steps(), "locate_tolerance is clamped to the number of steps");
+        passed &= check(rd_index.locate_budget(-1) == rd_index.num_steps(), "locate_budget is clamped to the number of steps");
+    }
+    passed &= test_optimal_selection(estimator);
+    passed &= test_optimal_progressive(estimator);
+    passed &= test_optimal_thinned(estimator);
+    passed &= test_rate_distortion_non_prefix(estimator);
+    passed &= test_rate_distortion_estimator(estimator, MDR::SNormErrorEstimator<T>(1, 2, 1));
+    return passed ? 0 : -1;
+}
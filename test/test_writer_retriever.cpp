@@ -0,0 +1,230 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <cmath>
+#include <unistd.h>
+#include "Writer/Writer.hpp"
+#include "Retriever/Retriever.hpp"
+#include "SizeInterpreter/SizeInterpreter.hpp"
+
+using namespace std;
+
+const int num_levels = 3;
+const int num_bitplanes = 6;
+
+// synthetic bitplanes of different sizes, every byte identifies its level, bitplane and position
+void generate_levels(vector<vector<uint8_t*>>& level_components, vector<vector<uint64_t>>& level_sizes){
+    level_components.clear();
+    level_sizes.clear();
+    for(int i=0; i<num_levels; i++){
+        vector<uint8_t*> components;
+        vector<uint64_t> sizes;
+        for(int j=0; j<num_bitplanes; j++){
+            uint64_t size = 100 + 37 * i + 13 * j;
+            uint8_t * bitplane = (uint8_t *) MDR::allocate(size);
+            for(uint64_t k=0; k<size; k++){
+                bitplane[k] = (i * 31 + j * 7 + k) % 251;
+            }
+            components.push_back(bitplane);
+            sizes.push_back(size);
+        }
+        level_components.push_back(components);
+        level_sizes.push_back(sizes);
+    }
+}
+
+void release_levels(vector<vector<uint8_t*>>& level_components){
+    for(auto& components:level_components){
+        for(auto& bitplane:components) MDR::deallocate(bitplane);
+    }
+    level_components.clear();
+}
+
+bool check(bool condition, const string& message){
+    cout << (condition ? "PASS: " : "FAIL: ") << message << endl;
+    return condition;
+}
+
+// write all levels and a metadata blob, then read them back in two progressive requests
+// past_end: also check that a request past the end of the levels returns no levels
+template<class Writer, class MakeRetriever>
+bool test_round_trip(Writer writer, MakeRetriever make_retriever, const string& name, bool past_end = false){
+    vector<vector<uint8_t*>> level_components;
+    vector<vector<uint64_t>> level_sizes;
+    generate_levels(level_components, level_sizes);
+    if(writer.streaming()){
+        for(int i=0; i<num_levels; i++){
+            writer.write_level_component(i, level_components[i], level_sizes[i]);
+        }
+    }
+    else{
+        writer.write_level_components(level_components, level_sizes);
+    }
+    vector<uint8_t> metadata(257);
+    for(int k=0; k<metadata.size(); k++) metadata[k] = (k * 13 + 5) % 256;
+    writer.write_metadata(metadata.data(), metadata.size());
+
+    bool passed = true;
+    auto retriever = make_retriever();
+    uint8_t * loaded_metadata = retriever.load_metadata();
+    passed &= check(memcmp(loaded_metadata, metadata.data(), metadata.size()) == 0, name + " metadata");
+    MDR::deallocate(loaded_metadata);
+
+    // half of the bitplanes of every level, then the rest
+    vector<uint8_t> level_num_bitplanes(num_levels, 0);
+    for(int target:{num_bitplanes / 2, num_bitplanes}){
+        vector<uint8_t> prev_level_num_bitplanes(level_num_bitplanes);
+        vector<uint64_t> retrieve_sizes(num_levels, 0);
+        for(int i=0; i<num_levels; i++){
+            for(int j=prev_level_num_bitplanes[i]; j<target; j++){
+                retrieve_sizes[i] += level_sizes[i][j];
+            }
+            level_num_bitplanes[i] = target;
+        }
+        auto retrieved = retriever.retrieve_level_components(level_sizes, retrieve_sizes, prev_level_num_bitplanes, level_num_bitplanes);
+        bool identical = (retrieved.size() == num_levels);
+        for(int i=0; identical && (i<num_levels); i++){
+            identical = (retrieved[i].size() == level_num_bitplanes[i] - prev_level_num_bitplanes[i]);
+            for(int j=prev_level_num_bitplanes[i]; identical && (j<level_num_bitplanes[i]); j++){
+                identical = (memcmp(retrieved[i][j - prev_level_num_bitplanes[i]], level_components[i][j], level_sizes[i][j]) == 0);
+            }
+        }
+        cout << endl;
+        passed &= check(identical, name + " bitplanes up to " + to_string(target));
+        retriever.release();
+    }
+    if(past_end){
+        auto retrieved = retriever.retrieve_level_components(level_sizes, vector<uint64_t>(num_levels, 1), level_num_bitplanes, level_num_bitplanes);
+        cout << endl;
+        passed &= check(retrieved.empty(), name + " returns no levels past the end");
+        retriever.release();
+    }
+    release_levels(level_components);
+    return passed;
+}
+
+// a request past the end of the level files returns no levels and leaves the offsets unchanged
+bool test_prefetch_read_failure(const string& metadata_file, const vector<string>& level_files){
+    vector<vector<uint8_t*>> level_components;
+    vector<vector<uint64_t>> level_sizes;
+    generate_levels(level_components, level_sizes);
+    MDR::ConcatLevelFileWriter writer(metadata_file, level_files);
+    for(int i=0; i<num_levels; i++){
+        writer.write_level_component(i, level_components[i], level_sizes[i]);
+    }
+    bool passed = true;
+    MDR::PrefetchLevelFileRetriever retriever(metadata_file, level_files);
+    vector<uint8_t> prev_level_num_bitplanes(num_levels, 0);
+    vector<uint8_t> level_num_bitplanes(num_levels, 1);
+    vector<uint64_t> retrieve_sizes(num_levels, 0);
+    vector<uint64_t> past_end(num_levels, 0);
+    for(int i=0; i<num_levels; i++){
+        retrieve_sizes[i] = level_sizes[i][0];
+        for(int j=0; j<num_bitplanes; j++) past_end[i] += level_sizes[i][j];
+        past_end[i] ++;
+    }
+    // the failed prefetch is read again by the request
+    retriever.prefetch(past_end);
+    auto failed = retriever.retrieve_level_components(level_sizes, past_end, prev_level_num_bitplanes, level_num_bitplanes);
+    passed &= check(failed.empty(), "prefetch retriever returns no levels for a failed read");
+    auto retrieved = retriever.retrieve_level_components(level_sizes, retrieve_sizes, prev_level_num_bitplanes, level_num_bitplanes);
+    bool identical = (retrieved.size() == num_levels);
+    for(int i=0; identical && (i<num_levels); i++){
+        identical = (retrieved[i].size() == 1) && (memcmp(retrieved[i][0], level_components[i][0], level_sizes[i][0]) == 0);
+    }
+    cout << endl;
+    passed &= check(identical, "prefetch retriever reads from the same offsets after a failed read");
+    retriever.release();
+    release_levels(level_components);
+    return passed;
+}
+
+// a data file shorter than the order table expects returns no levels
+bool test_reorganized_read_failure(const string& metadata_file, const string& data_file){
+    vector<vector<uint8_t*>> level_components;
+    vector<vector<uint64_t>> level_sizes;
+    generate_levels(level_components, level_sizes);
+    MDR::ReorganizedFileWriter<MDR::RoundRobinReorganizer> writer(metadata_file, data_file, MDR::RoundRobinReorganizer());
+    writer.write_level_components(level_components, level_sizes);
+    vector<uint8_t> metadata(16, 0);
+    writer.write_metadata(metadata.data(), metadata.size());
+    release_levels(level_components);
+    truncate(data_file.c_str(), level_sizes[0][0]);
+    MDR::ReorganizedFileRetriever retriever(metadata_file, data_file);
+    vector<uint8_t> prev_level_num_bitplanes(num_levels, 0);
+    vector<uint8_t> level_num_bitplanes(num_levels, num_bitplanes);
+    vector<uint64_t> retrieve_sizes(num_levels, 0);
+    auto retrieved = retriever.retrieve_level_components(level_sizes, retrieve_sizes, prev_level_num_bitplanes, level_num_bitplanes);
+    cout << endl;
+    return check(retrieved.empty(), "reorganized retriever returns no levels for a short data file");
+}
+
+// a container truncated after its index was loaded returns no levels
+bool test_container_read_failure(const string& data_file){
+    vector<vector<uint8_t*>> level_components;
+    vector<vector<uint64_t>> level_sizes;
+    generate_levels(level_components, level_sizes);
+    MDR::ContainerFileWriter writer(data_file, 64);
+    for(int i=0; i<num_levels; i++){
+        writer.write_level_component(i, level_components[i], level_sizes[i]);
+    }
+    vector<uint8_t> metadata(16, 0);
+    writer.write_metadata(metadata.data(), metadata.size());
+    release_levels(level_components);
+    MDR::ContainerFileRetriever retriever(data_file);
+    truncate(data_file.c_str(), level_sizes[0][0]);
+    vector<uint8_t> prev_level_num_bitplanes(num_levels, 0);
+    vector<uint8_t> level_num_bitplanes(num_levels, num_bitplanes);
+    vector<uint64_t> retrieve_sizes(num_levels, 0);
+    auto retrieved = retriever.retrieve_level_components(level_sizes, retrieve_sizes, prev_level_num_bitplanes, level_num_bitplanes);
+    cout << endl;
+    return check(retrieved.empty(), "container retriever returns no levels for a truncated container");
+}
+
+int main(int argc, char ** argv){
+    const string prefix = "test_writer_retriever";
+    vector<string> level_files;
+    for(int i=0; i<num_levels; i++){
+        level_files.push_back(prefix + "_level_" + to_string(i));
+    }
+    const string metadata_file = prefix + "_metadata";
+    const string data_file = prefix + "_data";
+    bool passed = true;
+
+    passed &= test_round_trip(MDR::ConcatLevelFileWriter(metadata_file, level_files), [&](){ return MDR::MmapLevelFileRetriever(metadata_file, level_files); }, "mmap", true);
+    passed &= test_prefetch_read_failure(metadata_file, level_files);
+    passed &= test_round_trip(MDR::ContainerFileWriter(data_file, 64), [&](){ return MDR::ContainerFileRetriever(data_file); }, "container");
+    passed &= test_container_read_failure(data_file);
+    // small segments so that bitplanes span several of them
+    passed &= test_round_trip(MDR::HPSSFileWriter(metadata_file, level_files, 1, 256, 4), [&](){ return MDR::HPSSFileRetriever(metadata_file, level_files, 4); }, "HPSS", true);
+    auto store = make_shared<MDR::InMemoryStore>();
+    passed &= test_round_trip(MDR::InMemoryWriter(store), [&](){ return MDR::InMemoryRetriever(store); }, "in-memory", true);
+    passed &= test_round_trip(MDR::ReorganizedFileWriter<MDR::RoundRobinReorganizer>(metadata_file, data_file, MDR::RoundRobinReorganizer()), [&](){ return MDR::ReorganizedFileRetriever(metadata_file, data_file); }, "round-robin reorganized");
+    passed &= test_reorganized_read_failure(metadata_file, data_file);
+    {
+        // bitplanes laid out in the order of a rate-distortion index
+        vector<vector<uint8_t*>> level_components;
+        vector<vector<uint64_t>> level_sizes;
+        generate_levels(level_components, level_sizes);
+        release_levels(level_components);
+        vector<vector<double>> level_errors;
+        for(int i=0; i<num_levels; i++){
+            vector<double> errors;
+            for(int j=0; j<=num_bitplanes; j++) errors.push_back(ldexp(1.0 + i, -2 * j + i));
+            level_errors.push_back(errors);
+        }
+        auto writer = MDR::ReorganizedFileWriter<MDR::RateDistortionReorganizer>(metadata_file, data_file, MDR::RateDistortionReorganizer());
+        writer.load_rate_distortion_index(MDR::build_rate_distortion_index(level_sizes, level_errors, MDR::SNormErrorEstimator<float>(1, num_levels - 1, 0)));
+        passed &= test_round_trip(writer, [&](){ return MDR::ReorganizedFileRetriever(metadata_file, data_file); }, "rate-distortion reorganized");
+    }
+
+    remove(metadata_file.c_str());
+    remove(data_file.c_str());
+    for(const auto& level_file:level_files){
+        remove(level_file.c_str());
+        for(int k=0; k<16; k++) remove(MDR::segment_name(level_file, k).c_str());
+    }
+    return passed ? 0 : -1;
+}